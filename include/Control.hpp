@@ -0,0 +1,53 @@
+#pragma once
+#include "pch.hpp"
+
+namespace Mixijo {
+
+    /**
+     * Control pipe, accepts one command per line and answers every
+     * command with one line. Commands are read on a background thread,
+     * but only run when the owning thread calls handle(), so they never
+     * race with the rest of the controller.
+     */
+    class Control {
+    public:
+        using Handler = std::function<std::string(std::string_view)>;
+
+        /**
+         * @param name name of the pipe, without the \\.\pipe\ prefix
+         * @param handler runs a command and returns the answer
+         */
+        Control(std::string name, Handler handler);
+        ~Control();
+
+        void start();
+        void stop();
+
+        /**
+         * Run all commands that came in since the last call.
+         */
+        void handle();
+
+        std::string_view name() const { return _name; }
+
+    private:
+        struct Request {
+            std::string command;
+            std::string answer{};
+            bool done = false;
+        };
+
+        std::string _name;
+        Handler _handler;
+        std::thread _thread{};
+        std::atomic<bool> _running{ false };
+        std::atomic<bool> _stopped{ true };
+        std::mutex _lock{};
+        std::condition_variable _condition{};
+        std::deque<Request*> _requests{};
+
+        void run();
+        void serve(void* pipe);
+        std::string request(std::string command);
+    };
+}
@@ -2,6 +2,13 @@
 #include "pch.hpp"
 #include "Processing/Processor.hpp"
 #include "Gui/Frame.hpp"
+#include "Executor.hpp"
+#include "Writer.hpp"
+#include "Logger.hpp"
+#include "Control.hpp"
+#include "Trace.hpp"
+#include "Scheduling.hpp"
+#include "Utils.hpp"
 
 namespace Mixijo {
 
@@ -22,6 +29,30 @@ namespace Mixijo {
         }
     };
 
+    /**
+     * Midi button that runs a command when pressed.
+     */
+    struct Button {
+        int cc;
+        std::string command;
+        std::string scene{};  // Recall this scene instead of running a command
+        double fade = -1;     // Crossfade time of the scene, -1 for the default
+        std::chrono::milliseconds debounce{ 250 };
+        std::chrono::steady_clock::time_point pressed{};
+        std::shared_ptr<std::atomic<bool>> running = std::make_shared<std::atomic<bool>>(false);
+    };
+
+    /**
+     * Time the gui takes per frame, logged with the information (CTRL + L).
+     */
+    struct FrameTimes {
+        std::size_t frames = 0;
+        double total = 0; // Milliseconds
+        double longest = 0;
+
+        void add(double ms) { ++frames, total += ms, longest = std::max(longest, ms); }
+    };
+
     struct Controller {
         static double maxDb;
         static double maxLin;
@@ -30,23 +61,161 @@ namespace Mixijo {
         static std::string audioDevice;
         static std::string midiinDevice;
         static std::string midioutDevice;
-        static std::vector<std::pair<int, std::string>> buttons;
+        static std::vector<Button> buttons;
+        static SpscQueue<int, 64> presses; // Button CCs pressed on the midi thread, run by the main thread
         static int selectedChannel;
         static bool selectedInput;
         static bool showConsole;
         static Processor processor;
         static Pointer<Frame> window;
         static std::ofstream logOutput;
+        static Mutex logLock;
+        static Logger logger; // For the audio and midi threads, see logline and errline for the others
+        static Executor executor;
+        static Writer writer;
+        static std::map<std::string, Scene, std::less<>> scenes;
+        static double sceneFade;
+        static double frameRate; // Frames per second of the gui
+        static FrameTimes frameTimes; // Since they were last logged
+        static json settings; // Currently applied settings, to find what changed on reload
+        static std::filesystem::file_time_type settingsTime;   // Modification time of the last settings that parsed
+        static std::filesystem::file_time_type settingsFailed; // Modification time of the last settings that didn't
+        static std::chrono::steady_clock::time_point settingsChecked;
+        static string_map<int> inputChannels;  // Channel name -> id, rebuilt when the channels change
+        static string_map<int> outputChannels;
+        static bool headless;                 // Running without a window
+        static std::atomic<bool> running;     // Cleared to stop the headless loop
+        static Control control;               // Control pipe for headless mode
+
+        /**
+         * Read and parse the settings file.
+         * @return settings, nothing if the file is missing or invalid
+         */
+        static std::optional<json> readSettings();
+
+        /**
+         * Apply all settings and reopen all devices, channels are built after
+         * the devices are opened, so their endpoints can be found.
+         * @param config settings
+         */
+        static void openDevices(json& config);
+
+        /**
+         * Only apply the settings that changed since they were last applied.
+         * The audio device is only reopened when the device, samplerate or
+         * buffersize changed, and the midi devices when the midi device changed.
+         */
+        static void reloadSettings();
+
+        /**
+         * Reload the settings when the settings file was modified, the
+         * modification time is checked at most every 250 milliseconds.
+         */
+        static void watchSettings();
+
+        static void applyGeneral(json& config);
+        static void applyButtons(json& config);
+        static void applyChannels(json& config);
+        static void applyTheme(json& config);
+
+        /**
+         * Update the channels in place when only their contents changed,
+         * channels are only rebuilt when channels were added or removed.
+         * @param config new settings
+         */
+        static void updateChannels(json& config);
+        static void applyEndpoints(json& channel, bool input, Channel& result);
+        static void applyMidiMappings(json& channel, bool input, int index);
 
-        static void refreshSettings();
         static void loadRouting();
-        static void saveRouting();
-        static void start();
+        /**
+         * Save the routing on the background writer.
+         * @param wait wait until the routing is written to disk
+         */
+        static void saveRouting(bool wait = false);
+
+        /**
+         * Write the recorded trace zones to logs/, does nothing
+         * unless built with MIXIJO_TRACING.
+         */
+        static void dumpTrace();
+
+        /**
+         * Start the mixer, blocks until it is closed.
+         * @param headless run without a window, controlled by the settings, midi and the control pipe
+         */
+        static void start(bool headless = false);
+        static void startEngine();
+        static void runGui();
+        static void runHeadless();
+
+        /**
+         * Run a command from the control pipe.
+         * @param line command with its arguments, separated by spaces, quote arguments with spaces
+         * @return answer, "ok", an error starting with "error:", or the requested information
+         */
+        static std::string command(std::string_view line);
+
+        /**
+         * Rebuild the channel name indexes, call when channels are added or renamed.
+         */
+        static void indexChannels();
+
+        /**
+         * Find a channel given its name.
+         * @param name name of the channel
+         * @param input is the channel an input
+         * @return id of the found channel, -1 if not found
+         */
+        static int findChannel(std::string_view name, bool input);
+
+        /**
+         * Load all scenes from the scenes folder that match the current channels.
+         */
+        static void loadScenes();
+
+        /**
+         * Capture the current state of the mixer and save it as a scene.
+         * @param name name of the scene, also its file name in scenes/
+         * @return false if the name isn't a plain file name
+         */
+        static bool saveScene(std::string_view name);
+
+        /**
+         * Recall a scene that was loaded or saved before.
+         * @param name name of the scene
+         * @param ms crossfade time in milliseconds, -1 for the default
+         */
+        static void recallScene(std::string_view name, double ms = -1);
+
+        /**
+         * @return hash of the names and order of the channels
+         */
+        static std::uint64_t layout();
+
+        /**
+         * Run the buttons that were pressed since the last call, only called from the main thread.
+         */
+        static void handleButtons();
+
+        /**
+         * Dispatch the window messages that are waiting, so input is handled right
+         * away, also between two frames. Only called from the main thread.
+         * @return false once the window was closed
+         */
+        static bool handleEvents();
+
+        /**
+         * Run the command of a button on the executor.
+         * @param button button that was pressed
+         */
+        static void run(Button& button);
 
         template<class ...Args>
         static void logline(Args&&... args) {
             const auto now = std::chrono::system_clock::now();
             std::string prefix = std::format("[Mixijo] {:%EY-%Om-%Od %OH:%OM:%OS} [log] ", now);
+            std::scoped_lock _{ logLock };
             std::cout << prefix;
             ((std::cout << args), ...);
             std::cout << '\n';
@@ -61,6 +230,7 @@ namespace Mixijo {
         static void errline(Args&&... args) {
             const auto now = std::chrono::system_clock::now();
             std::string prefix = std::format("[Mixijo] {:%EY-%Om-%Od %OH:%OM:%OS} [err] ", now);
+            std::scoped_lock _{ logLock };
             std::cout << prefix;
             ((std::cout << args), ...);
             std::cout << '\n';
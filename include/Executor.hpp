@@ -0,0 +1,48 @@
+#pragma once
+#include "pch.hpp"
+
+namespace Mixijo {
+
+    /**
+     * Small thread pool with a bounded job queue. Used to run work that
+     * may take a while, like the commands linked to midi buttons, without
+     * blocking the thread that triggered it.
+     */
+    class Executor {
+    public:
+        using Job = std::function<void(void)>;
+
+        /**
+         * @param threads amount of worker threads
+         * @param capacity maximum amount of queued jobs
+         */
+        Executor(std::size_t threads = 2, std::size_t capacity = 32);
+        ~Executor();
+
+        void start();
+        void stop();
+
+        /**
+         * Queue a job, never blocks.
+         * @param job job to run on one of the worker threads
+         * @return false if the queue is full or the executor isn't running
+         */
+        bool submit(Job job);
+
+        /**
+         * @return false once the executor is stopping, long jobs should give up
+         */
+        bool running();
+
+    private:
+        std::size_t _threadCount;
+        std::size_t _capacity;
+        std::vector<std::thread> _threads{};
+        std::deque<Job> _jobs{};
+        std::mutex _lock{};
+        std::condition_variable _condition{};
+        bool _running = false;
+
+        void run();
+    };
+}
@@ -2,17 +2,23 @@
 #include "pch.hpp"
 #include "Utils.hpp"
 #include "Gui/RouteButton.hpp"
+#include "Processing/Channel.hpp"
+#include "Processing/Analyzer.hpp"
 
 namespace Mixijo::Gui {
     struct Channel : Object {
 
         int id;
         bool input;
-        std::string name;
+        bool visible = true; // Hidden channels aren't updated or drawn
         std::string gain = "";
         std::vector<double> smoothed{};
         double pressGain = 1;
-        double counter = 0;
+        std::chrono::steady_clock::time_point lastClick{};   // For double click detection
+        std::chrono::steady_clock::time_point lastUpdate{};  // For frame rate independent meters
+
+        constexpr static std::chrono::milliseconds doubleClick{ 333 };
+        constexpr static double meterTime = 0.0747; // Meter integration time in seconds, 0.8 per frame at 60 fps
 
         StateLinked<Animated<Color>> background{};
         StateLinked<Animated<Color>> slider{};
@@ -28,10 +34,21 @@ namespace Mixijo::Gui {
 
         Pointer<RouteButton> route;
 
-        Channel(int id, bool in, std::string_view name);
+        Channel(int id, bool in);
+
+        /**
+         * @return the processing channel this channel displays
+         */
+        Mixijo::Channel& model() const;
 
         Dimensions<int> bars() const;
 
+        /**
+         * Move this channel and its route button out of sight until the mixer
+         * places it again, hidden channels aren't updated, so it's done here.
+         */
+        void hide();
+
         void mousePress(const MousePress& e);
         void mouseClick(const MouseClick& e);
         void mouseDrag(const MouseDrag& e);
@@ -40,5 +57,24 @@ namespace Mixijo::Gui {
         void update() override;
 
         void updateTheme();
+
+    private:
+        struct Tick {
+            float y;
+            const char* label; // nullptr for ticks without a label
+        };
+
+        // Geometry of the dB scale, only recomputed when the size of the bars changes
+        mutable Dimensions<int> _scaleBars{ 0, 0, -1, -1 };
+        mutable std::vector<Tick> _scaleTicks{};
+        mutable float _scaleZero = 0;
+
+        bool _analyzed = false;   // Draw the spectrum instead of the meters
+        Spectrum _spectrum{};     // Latest spectrum of the analyzer
+
+        double _shownGain = -1; // Gain the gain text was formatted for
+        Dimensions<float> _layout{ 0, 0, -1, -1 }; // Dimensions the route button was placed for
+
+        void layoutScale(const Dimensions<int>& bars) const;
     };
 }
\ No newline at end of file
@@ -2,6 +2,17 @@
 #include "pch.hpp"
 
 namespace Mixijo {
+    /**
+     * Check if two dimensions have the same position and size.
+     * @param a first dimensions
+     * @param b second dimensions
+     * @return true if equal
+     */
+    template<class A, class B>
+    constexpr bool sameDimensions(const Dimensions<A>& a, const Dimensions<B>& b) {
+        return a.x() == b.x() && a.y() == b.y() && a.width() == b.width() && a.height() == b.height();
+    }
+
     struct Frame : Window {
         StateLinked<Animated<Color>> border;
         StateLinked<Animated<Color>> title;
@@ -23,6 +34,8 @@ namespace Mixijo {
         Pointer<Button> minimize{ emplace<Button>(2) };
         Pointer<Object> mixer;
         bool initialResize = false;
+        Dimensions<float> layout{ 0, 0, -1, -1 }; // Size the children were placed for
+        bool layoutMaximized = false;
 
         Frame(Window::Construct);
 
@@ -30,5 +43,10 @@ namespace Mixijo {
         void update() override;
 
         void updateTheme();
+
+        /**
+         * @return true when the window is minimized
+         */
+        bool minimized() const;
     };
 }
\ No newline at end of file
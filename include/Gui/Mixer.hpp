@@ -10,12 +10,29 @@ namespace Mixijo::Gui {
         StateLinked<Animated<Color>> background;
         StateLinked<Animated<Color>> divider;
         float dividerX = 0;
+        std::size_t first = 0;                  // First visible channel when they don't all fit
+        constexpr static float minWidth = 80;   // Minimum width of a channel before banking
+
+
+        /**
+         * Recompute the layout on the next update, call when channels are added or removed.
+         */
+        void invalidate() { _layoutValid = false; }
 
         void mouseClick(const MousePress& e);
+        void mouseWheel(const MouseWheel& e);
 
         void draw(DrawContext& p) const override;
         void update() override;
 
         void updateTheme();
+
+    private:
+        bool _layoutValid = false;
+        Dimensions<float> _layout{ 0, 0, -1, -1 }; // Dimensions the channels were placed for
+        std::size_t _layoutCount = 0;              // Amount of channels that were placed
+        std::size_t _bank = 1;                     // Amount of channels that fit, so scrolling stops at the last bank
+
+        void updateVisible();
     };
 }
\ No newline at end of file
@@ -0,0 +1,82 @@
+#pragma once
+#include "pch.hpp"
+#include "Processing/Graph.hpp"
+#include "Utils.hpp"
+#include <jack/jack.h>
+
+namespace Mixijo::Jack {
+
+    /**
+     * Runs the processing graph as a JACK client, for Linux. Every endpoint the channels
+     * in the settings use becomes a port of the client, named after the endpoint, and the
+     * graph is processed in the JACK process callback.
+     *
+     * JACK's port buffers hold floats and the graph processes doubles, so the process
+     * callback converts the samples of every input port into a buffer of doubles, and the
+     * output buffers back into the output ports, one pass each way. Those buffers are
+     * allocated when the buffer size changes, never in the process callback.
+     */
+    class Client {
+    public:
+        Graph graph{}; // Only change it before activating the client
+
+        ~Client();
+
+        /**
+         * Open a client on a running JACK server, with the channels of the settings. Input
+         * ports are named "in " and output ports "out " followed by the endpoint, so an endpoint
+         * can be both. Errors are written to the error output.
+         * @param name name of the client
+         * @param settings settings.json, only the channels are used
+         * @param server name of the JACK server, empty for the default one
+         * @return false if the server isn't running or a port couldn't be registered
+         */
+        bool open(std::string_view name, json& settings, std::string_view server = {});
+
+        /**
+         * Set the gains, limiters and crosspoints like routing.txt does, the channels start
+         * at them without smoothing. Call before activating the client.
+         * @param lines lines of routing.txt
+         */
+        void route(const std::vector<std::string>& lines);
+
+        /**
+         * Start processing.
+         * @return false if JACK refused
+         */
+        bool activate();
+
+        /**
+         * Stop processing and leave the server.
+         */
+        void close();
+
+        /**
+         * @return false once the server shut down or dropped the client
+         */
+        bool running() const { return _client && !_shutdown; }
+
+        /**
+         * @param input input or output ports
+         * @return full names of the ports, "client:port", for connecting them
+         */
+        std::vector<std::string> ports(bool input) const;
+
+    private:
+        jack_client_t* _client = nullptr;
+        std::vector<jack_port_t*> _inputs{};
+        std::vector<jack_port_t*> _outputs{};
+        std::vector<std::string> _inputNames{};  // Endpoints of the ports, the index is the endpoint id in the graph
+        std::vector<std::string> _outputNames{};
+        std::unique_ptr<Buffer<double>> _in{};
+        std::unique_ptr<Buffer<double>> _out{};
+        std::atomic<bool> _shutdown{ false };
+
+        int endpoint(std::string_view name, bool input);
+        void resize(std::size_t frames);
+
+        static int process(jack_nframes_t frames, void* self);
+        static int bufferSize(jack_nframes_t frames, void* self);
+        static void shutdown(void* self);
+    };
+}
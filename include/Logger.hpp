@@ -0,0 +1,91 @@
+#pragma once
+#include "pch.hpp"
+#include "Processing/Queue.hpp"
+
+namespace Mixijo {
+
+    /**
+     * Real-time safe logger. Producers only copy a fixed-size record into
+     * a lock-free queue, without allocating or formatting. A background
+     * thread timestamps, formats and writes the records in batches.
+     * Arguments can be numbers, booleans, and string literals; any other
+     * string must outlive the log call, so only use literals.
+     */
+    class Logger {
+    public:
+        enum Level : std::uint8_t { Log, Error };
+
+        struct Argument {
+            enum Type : std::uint8_t { Text, Signed, Unsigned, Floating, Boolean } type = Text;
+            union {
+                const char* text = "";
+                std::int64_t integral;
+                std::uint64_t unsigned_integral;
+                double floating;
+                bool boolean;
+            };
+        };
+
+        constexpr static std::size_t MaxArguments = 8;
+
+        struct Record {
+            std::chrono::system_clock::time_point time{};
+            Level level = Log;
+            std::uint8_t count = 0;
+            std::array<Argument, MaxArguments> arguments{};
+        };
+
+        /**
+         * @param interval time between batches
+         */
+        Logger(std::chrono::milliseconds interval = std::chrono::milliseconds(10));
+        ~Logger();
+
+        void start();
+        void stop();
+
+        /**
+         * Log a message, safe to call from the audio and midi threads.
+         * @param args parts of the message, numbers, booleans or string literals
+         */
+        template<class ...Args> requires (sizeof...(Args) <= MaxArguments)
+        void logline(const Args&... args) { post(Log, args...); }
+
+        /**
+         * Log an error, safe to call from the audio and midi threads.
+         * @param args parts of the message, numbers, booleans or string literals
+         */
+        template<class ...Args> requires (sizeof...(Args) <= MaxArguments)
+        void errline(const Args&... args) { post(Error, args...); }
+
+        /**
+         * @return amount of messages dropped because the queue was full
+         */
+        std::size_t dropped() const { return _dropped.load(std::memory_order_relaxed); }
+
+    private:
+        MpmcQueue<Record, 1024> _records{};
+        std::atomic<std::size_t> _dropped{ 0 };
+        std::size_t _reported = 0;
+        std::chrono::milliseconds _interval;
+        std::atomic<bool> _running{ false };
+        std::thread _thread{};
+
+        template<class ...Args>
+        void post(Level level, const Args&... args) {
+            Record _record{ std::chrono::system_clock::now(), level, sizeof...(Args) };
+            std::size_t _index = 0;
+            ((_record.arguments[_index++] = argument(args)), ...);
+            if (!_records.push(_record)) _dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        static Argument argument(const char* text) { Argument _arg{ Argument::Text }; _arg.text = text; return _arg; }
+        static Argument argument(bool value) { Argument _arg{ Argument::Boolean }; _arg.boolean = value; return _arg; }
+        static Argument argument(std::signed_integral auto value) { Argument _arg{ Argument::Signed }; _arg.integral = value; return _arg; }
+        static Argument argument(std::unsigned_integral auto value) { Argument _arg{ Argument::Unsigned }; _arg.unsigned_integral = value; return _arg; }
+        static Argument argument(std::floating_point auto value) { Argument _arg{ Argument::Floating }; _arg.floating = value; return _arg; }
+
+        void run();
+        void write();
+    };
+}
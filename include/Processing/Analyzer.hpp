@@ -0,0 +1,116 @@
+#pragma once
+#include "pch.hpp"
+#include "Processing/Queue.hpp"
+
+namespace Mixijo {
+
+    /**
+     * Spectrum of the analyzed channel, in dB per log-frequency band.
+     */
+    struct Spectrum {
+        constexpr static std::size_t Bands = 64;
+        constexpr static double MinFrequency = 20;
+        constexpr static double MaxFrequency = 20000;
+        constexpr static float Floor = -120; // dB, level of silence and of bands above nyquist
+
+        bool input = false;
+        int channel = -1; // -1 until something was analyzed
+        std::array<float, Bands> level{};
+        std::array<float, Bands> peak{};
+    };
+
+    /**
+     * Spectrum analyzer of a single channel. The audio thread taps the mono
+     * sum of the analyzed channel into a lock-free queue in blocks, the
+     * analysis thread runs windowed FFTs with overlap on it, and publishes
+     * the spectrum through a triple buffer for the gui. Nothing runs while
+     * no channel is analyzed.
+     */
+    class Analyzer {
+    public:
+        constexpr static std::size_t Size = 2048;     // FFT size
+        constexpr static std::size_t Hop = Size / 4;  // Samples between FFTs, 75% overlap
+        constexpr static std::size_t BlockSize = 64;  // Samples per block in the tap queue
+        constexpr static double PeakHold = 1;         // Seconds a peak is held
+        constexpr static double PeakDecay = 24;       // dB per second a peak falls after the hold
+
+        struct Target {
+            bool input;
+            int channel; // -1 when nothing is analyzed
+        };
+
+        ~Analyzer();
+
+        /**
+         * Start analyzing a channel, stops analyzing the previous one.
+         * @param input input or output channel
+         * @param channel index of the channel
+         * @param sampleRate sample rate of the audio device
+         */
+        void open(bool input, int channel, double sampleRate);
+        void close();
+
+        /**
+         * @return true if this channel is analyzed
+         */
+        bool opened(bool input, int channel) const;
+
+        /**
+         * @return channel the audio thread should tap
+         */
+        Target target() const { return decode(_target.load(std::memory_order_acquire)); }
+
+        /**
+         * Tap a frame of the analyzed channel, only call this from the audio thread.
+         * @param values samples of the channel
+         * @param gain gain that still has to be applied to the samples
+         */
+        void tap(std::span<const double> values, double gain);
+
+        /**
+         * Latest spectrum, only call this from the gui thread.
+         * @return spectrum, check its channel before using it
+         */
+        const Spectrum& read() { return _spectra.read(); }
+
+    private:
+        struct Block {
+            int target = -1;
+            std::array<float, BlockSize> samples{};
+        };
+
+        std::atomic<int> _target{ -1 };
+        SpscQueue<Block, 256> _blocks{};
+        TripleBuffer<Spectrum> _spectra{};
+        std::thread _thread{};
+        std::atomic<bool> _running{ false };
+
+        // Only touched by the audio thread
+        Block _block{};
+        std::size_t _filled = 0;
+
+        // Only touched by the analysis thread
+        double _sampleRate = 48000;
+        std::vector<float> _history{};   // Last Size samples, circular
+        std::size_t _position = 0;       // Write position in the history
+        std::size_t _pending = 0;        // Samples since the last FFT
+        std::vector<float> _window{};
+        std::vector<float> _real{};      // Even samples, then the real part of the FFT
+        std::vector<float> _imag{};      // Odd samples, then the imaginary part of the FFT
+        std::vector<float> _power{};     // Power of every bin of the real FFT, up to nyquist
+        std::vector<float> _cos{};       // Twiddle factors
+        std::vector<float> _sin{};
+        std::vector<std::size_t> _reversed{};
+        std::array<std::pair<std::size_t, std::size_t>, Spectrum::Bands> _bands{}; // First and last FFT bin of every band
+        std::array<float, Spectrum::Bands> _peaks{};
+        std::array<std::size_t, Spectrum::Bands> _held{}; // Hops left before a peak starts falling
+
+        void run(int target);
+        void prepare();
+        void analyze(int target);
+        void transform();
+
+        static int encode(bool input, int channel) { return channel * 2 + input; }
+        static Target decode(int target) { return target < 0 ? Target{ false, -1 } : Target{ (target & 1) != 0, target / 2 }; }
+    };
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include "pch.hpp"
+#include "Scheduling.hpp"
+
+namespace Mixijo {
+
+    /**
+     * One zeroed, 64-byte aligned block of doubles, handed out in
+     * pieces. A graph lays out the samples, peaks and routing of all its
+     * channels in one, so a new graph is a single allocation, and a single
+     * block to lock in RAM. Gains and their smoothing stay in the channels,
+     * and the limiter keeps its own delay lines.
+     */
+    class Arena {
+    public:
+        constexpr static std::size_t Alignment = 64;
+
+        Arena() = default;
+
+        /**
+         * @param size number of doubles in the block
+         */
+        explicit Arena(std::size_t size);
+
+        /**
+         * Take the next doubles of the block.
+         * @param count number of doubles
+         * @param align start at a 64-byte boundary
+         * @return doubles, empty if the block is too small
+         */
+        std::span<double> take(std::size_t count, bool align = false);
+
+        /**
+         * Lock the block in RAM when memory locking is enabled, it's
+         * unlocked when the block is freed. See Scheduling::lock.
+         */
+        void lock();
+
+        /**
+         * Unlock the block if it was locked, when memory locking is disabled.
+         */
+        void unlock();
+
+        /**
+         * @param count number of doubles
+         * @return space that count doubles take when the next piece is aligned
+         */
+        constexpr static std::size_t aligned(std::size_t count) {
+            constexpr std::size_t _perLine = Alignment / sizeof(double);
+            return (count + _perLine - 1) / _perLine * _perLine;
+        }
+
+    private:
+        struct Free {
+            std::size_t locked; // Bytes locked in RAM, zero when value-initialized by the unique_ptr
+
+            void operator()(double* data) const {
+                if (locked) Scheduling::unlock(data, locked);
+                ::operator delete[](data, std::align_val_t{ Alignment });
+            }
+        };
+
+        std::unique_ptr<double[], Free> _data{};
+        std::size_t _size = 0;
+        std::size_t _used = 0;
+    };
+}
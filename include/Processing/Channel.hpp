@@ -96,37 +96,90 @@ namespace Mixijo {
 	};
 
     struct Channel {
+        std::string name = "channel"; // Used to find the channel in the routing, scenes and control commands
         std::vector<int> endpoints{};
-        std::vector<double> values{};
-        std::vector<double> peaks{};
+        std::span<double> values{}; // One per endpoint, in the arena of the graph, see Graph::layout
+        std::span<double> peaks{};  // Loudest sample of the current block, the meter feedback folds them into meter
+        std::span<double> held{};   // Loudest sample since the gui last read them, reset by the gui
 
 		Limiter limiter;
 
-        enum MidiLink { Gain };
+        enum MidiLink { Gain, Meter };
 
-        std::map<int, MidiLink> midiLinks;
         double gain = 1;
 		bool enableLimiter = false;
 
-        void getSettings(std::ofstream& file);
+        double smoothedGain = 1; // Gain that is actually applied, follows gain
+        double smoothing = 1;    // Smoothing coefficient per sample
+        bool jump = false;       // Start at the gain when handed to the audio thread, instead of smoothing to it, see Graph::adopt
+
+        double publishedGain = -1; // Last gain sent to the midi feedback
+        double meter = 0;          // Peak since the last meter feedback, only touched by the audio thread
+
+        /**
+         * Set the smoothing time of the gain.
+         * @param sampleRate sample rate
+         * @param ms time constant of the smoothing in milliseconds
+         */
+        void prepare(double sampleRate, double ms = 5);
+
+        /**
+         * Move the smoothed gain one sample towards the target gain.
+         * @return smoothed gain
+         */
+        double nextGain() {
+            const double _diff = gain - smoothedGain;
+            if (std::abs(_diff) < 1e-9) return smoothedGain = gain; // avoid denormals
+            return smoothedGain += _diff * smoothing;
+        }
+
+        void getSettings(std::ostream& file);
         void setSetting(std::string_view name, double val);
-        void addMidiLink(std::string_view name, int id);
-        void handleMidi(int id, int value);
+        void set(MidiLink link, double value);
         void add(int endpoint);
         void remove(int endpoint);
+        void clearEndpoints();
         void process();
     };
 
     struct InputChannel : Channel {
-        std::vector<double> output_levels{};
+        std::span<double> output_levels{}; // Row of the routing matrix, in the arena of the graph
 		bool idle = false;
 
-        void generate(Buffer<double>::Frame& frame);
+        void generate(Buffer<double>::Frame& frame) { _generate(*this, frame); }
+
+        /**
+         * Pick the kernels for the current amount of endpoints, mono, stereo,
+         * 6 and 8 channels have their own, anything else uses the generic ones.
+         * Called by the processor when it lays out the channels.
+         */
+        void specialize();
+
+    private:
+        using Generate = void(*)(InputChannel&, Buffer<double>::Frame&);
+        Generate _generate = &generateWidth<0>;
+
+        // Width 0 is the generic kernel, it works for any amount of endpoints
+        template<std::size_t Width> static void generateWidth(InputChannel& self, Buffer<double>::Frame& frame);
     };
 
     struct OutputChannel : Channel {
-        void receive(const std::vector<double>& in, double level);
+        void receive(std::span<const double> in, double level) { _receive(*this, in, level); }
         void clear();
-        void generate(Buffer<double>::Frame& frame);
+        void generate(Buffer<double>::Frame& frame) { _generate(*this, frame); }
+
+        /**
+         * Pick the kernels for the current amount of endpoints, see InputChannel::specialize.
+         */
+        void specialize();
+
+    private:
+        using Receive = void(*)(OutputChannel&, std::span<const double>, double);
+        using Generate = void(*)(OutputChannel&, Buffer<double>::Frame&);
+        Receive _receive = &receiveWidth<0>;
+        Generate _generate = &generateWidth<0>;
+
+        template<std::size_t Width> static void receiveWidth(OutputChannel& self, std::span<const double> in, double level);
+        template<std::size_t Width> static void generateWidth(OutputChannel& self, Buffer<double>::Frame& frame);
     };
 }
\ No newline at end of file
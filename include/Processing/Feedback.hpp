@@ -0,0 +1,61 @@
+#pragma once
+#include "pch.hpp"
+#include "Processing/Queue.hpp"
+
+namespace Mixijo {
+    struct Processor;
+
+    /**
+     * Sends parameter and meter feedback to the midi-out device on its own
+     * thread, and forwards the incoming midi events to it. Parameter changes
+     * are published by the audio thread, coalesced per target here, and sent
+     * at a limited rate. Nothing in here ever blocks the midi-in handler.
+     */
+    struct Feedback {
+        Feedback(Processor& processor);
+        ~Feedback();
+
+        void start();
+        void stop();
+
+        /**
+         * Queue an incoming midi event to be forwarded to the midi-out device.
+         * Never blocks, the event is dropped when the queue is full.
+         * @param e midi event
+         */
+        void forward(const Midijo::Event& e);
+
+        std::atomic<double> rate{ 30 }; // Messages per second, per target, read by the audio thread
+
+    private:
+        Processor& _processor;
+        std::thread _thread;
+        std::atomic<bool> _running{ false };
+        std::atomic<std::size_t> _dropped{ 0 };
+
+        SpscQueue<Midijo::Event, 1024> _thru{};
+
+        // Only touched by the feedback thread, the mappings are copied while holding the
+        // midi lock, so midi-out is only ever written without it
+        struct Mapping {
+            int type = 0; // Processor::MidiSource::Type
+            int number = 0;
+            int lsb = -1;
+            std::chrono::steady_clock::time_point touched{};
+        };
+
+        std::size_t _generation = static_cast<std::size_t>(-1);
+        std::vector<Mapping> _mappings{};
+        std::unordered_map<std::uint64_t, std::vector<std::size_t>> _targets{};
+        std::vector<std::optional<double>> _pending{};
+        std::vector<int> _sent{};
+
+        void run();
+        void rebuild();
+        void collect();
+        void flush();
+        void send(std::size_t mapping, int value);
+
+        static std::uint64_t key(bool input, int channel, int link);
+    };
+}
@@ -0,0 +1,113 @@
+#pragma once
+#include "pch.hpp"
+#include "Processing/Channel.hpp"
+#include "Processing/Scene.hpp"
+#include "Processing/Analyzer.hpp"
+#include "Processing/Arena.hpp"
+#include "Trace.hpp"
+
+namespace Mixijo {
+
+    /**
+     * The channels of the mixer and the order they're processed in. The processor
+     * runs it from the audio callback, the tests and benchmarks run the same code
+     * with buffers filled in code.
+     */
+    struct Graph {
+        std::vector<InputChannel> inputs;
+        std::vector<OutputChannel> outputs;
+
+        // Scene crossfade, the gains and crosspoints move from one scene to the other block by block
+        Scene fadeFrom{};
+        Scene fadeTo{};
+        std::size_t fadeLength = 0;
+        std::size_t fadePosition = 0;
+        bool startsFade = false; // Set when recalling a scene, otherwise adopt continues the crossfade of the previous graph
+
+        Graph() = default;
+
+        /**
+         * Copy the channels of another graph, laid out in a new arena. Only reads what
+         * the audio thread never changes, so the other graph may be processed meanwhile,
+         * the parameters come from a scene the audio thread captured.
+         * @param other graph to copy
+         * @param parameters gains, crosspoints and limiter flags of the other graph
+         */
+        Graph(const Graph& other, const Scene& parameters);
+
+        /**
+         * Take over the state of the graph the audio thread processed until now, for
+         * the channels that kept their endpoints: the gain smoothing, held peaks, meter
+         * feedback, limiter and the crossfade. Called by the audio thread, without allocating.
+         * @param previous graph that was processed until now
+         */
+        void adopt(Graph& previous);
+
+        /**
+         * Lay out the samples, peaks and routing of all channels in one arena,
+         * only when channels or endpoints changed. The routing is kept, the
+         * peaks and held peaks are reset.
+         * @param specialize pick the kernels for the widths of the channels, otherwise keep the generic ones
+         */
+        void layout(bool specialize = true);
+
+        /**
+         * Lock or unlock the arena in RAM after memory locking was toggled, new
+         * arenas lock themselves. Only call this from the thread that lays out.
+         * @param locked lock or unlock
+         */
+        void lockArena(bool locked);
+
+        /**
+         * Capture the current gains, crosspoints and limiter flags.
+         * @param scene destination
+         */
+        void capture(Scene& scene) const;
+
+        /**
+         * Process one block, without allocating or waiting: the crossfade, then
+         * every frame. Frames apply the changes that are due, generate the inputs,
+         * sum them into the outputs, tap the analyzer, generate the outputs and
+         * clamp the endpoints. Afterwards the peaks are those of this block, and
+         * they're added to the held peaks of the gui.
+         * @param in input endpoints, read only
+         * @param out output endpoints, overwritten
+         * @param analyzer analyzer to tap the channel it targets into, nullptr for none
+         * @param changes called with the frame in the block before every frame, applies the parameter changes that are due
+         */
+        void process(Buffer<double>& in, Buffer<double>& out, Analyzer* analyzer, std::invocable<std::size_t> auto&& changes) {
+            MIXIJO_TRACE("Graph::process");
+            const std::size_t _frames = out.Frames();
+            fade(_frames);
+            begin(out, analyzer);
+            for (std::size_t i = 0; i < _frames; ++i) {
+                changes(i);
+                auto _in = in[i], _out = out[i];
+                frame(_in, _out);
+            }
+            end();
+        }
+
+        /**
+         * Process one block without parameter changes.
+         */
+        void process(Buffer<double>& in, Buffer<double>& out, Analyzer* analyzer = nullptr) {
+            process(in, out, analyzer, [](std::size_t) {});
+        }
+
+    private:
+        Arena _arena{}; // Samples, peaks and held peaks of all channels back to back, then the routing matrix
+        std::span<double> _allPeaks{}; // Peaks of all channels
+        std::span<double> _allHeld{};
+
+        // Channel the analyzer taps this block, picked in begin
+        Analyzer* _analyzer = nullptr;
+        const Channel* _tap = nullptr;
+        bool _tapInput = false;
+
+        void fade(std::size_t frames);
+        void begin(Buffer<double>& out, Analyzer* analyzer);
+        void frame(Buffer<double>::Frame& in, Buffer<double>::Frame& out);
+        void end();
+    };
+}
@@ -1,32 +1,85 @@
 #pragma once
 #include "pch.hpp"
 #include "Processing/Channel.hpp"
+#include "Processing/Queue.hpp"
+#include "Processing/Feedback.hpp"
+#include "Processing/Scene.hpp"
+#include "Processing/Analyzer.hpp"
+#include "Processing/Graph.hpp"
+#include "Realtime.hpp"
+#include "Utils.hpp"
 
 namespace Mixijo {
+    /**
+     * Streams the graph with the ASIO device on Windows. The graph itself doesn't
+     * depend on the device, see process, on Linux Jack::Client runs it instead.
+     */
     struct Processor : Stream<Audijo::Api::Asio> {
-        template<class Type> struct Storage {
-            auto begin(this auto& self) { return self._data.begin(); }
-            auto end(this auto& self) { return self._data.end(); }
-            std::size_t size() const { return _data.size(); }
-            void clear() { _data.clear(); }
-            decltype(auto) operator[](this auto& self, std::size_t i) { return self._data[i]; }
+        // Channels of the graph, with the bookkeeping of the processor when adding and removing them
+        template<class Type, std::vector<Type> Graph::* Channels> struct Storage {
+            auto begin(this auto& self) { return self.data().begin(); }
+            auto end(this auto& self) { return self.data().end(); }
+            std::size_t size() const { return data().size(); }
+            void clear() { data().clear(); }
+            decltype(auto) operator[](this auto& self, std::size_t i) { return self.data()[i]; }
         protected:
-            std::vector<Type> _data;
             Processor& self;
             Storage(Processor& self) : self(self) {}
+            std::vector<Type>& data() const { return self._view->*Channels; }
             friend class Processor;
         };
 
-        struct Inputs : Storage<InputChannel> {
+        struct Inputs : Storage<InputChannel, &Graph::inputs> {
             InputChannel& add();
             void remove(int index);
         };
 
-        struct Outputs : Storage<OutputChannel> {
+        struct Outputs : Storage<OutputChannel, &Graph::outputs> {
             OutputChannel& add();
             void remove(int index);
         };
 
+        /**
+         * Midi control that can be mapped to a parameter. All sources
+         * are resolved to a 14-bit value before they are applied.
+         */
+        struct MidiSource {
+            enum Type { CC, CC14, NRPN, PitchBend };
+            Type type = CC;
+            int number = 0; // controller, msb controller, nrpn parameter, or midi channel
+            int lsb = -1;   // lsb controller for 14-bit CC pairs
+        };
+
+        /**
+         * Parameter of a channel that is controlled by a midi source.
+         */
+        struct MidiTarget {
+            bool input;
+            int channel;
+            Channel::MidiLink link;
+        };
+
+        struct MidiMapping {
+            MidiSource source;
+            MidiTarget target;
+            bool feedback = false; // send value changes to the midi-out device
+            int msb = 0; // last received msb of a 14-bit CC pair
+            std::chrono::steady_clock::time_point touched{}; // last time it was received
+        };
+
+        /**
+         * Resolved parameter change, posted from the midi thread and
+         * applied by the audio thread at the sample it was stamped with.
+         */
+        struct ParameterChange {
+            std::uint64_t time;
+            std::size_t generation;
+            bool input;
+            int channel;
+            Channel::MidiLink link;
+            double value;
+        };
+
         MidiIn<Midijo::Windows> midiin;
         MidiOut<Midijo::Windows> midiout;
 
@@ -34,13 +87,37 @@ namespace Mixijo {
 
         Processor();
 
+        /**
+         * Close and reopen all devices, the audio and midi devices are opened concurrently.
+         * @return true if all devices opened successfully
+         */
         bool init();
         Audijo::Error initAudio();
         Midijo::Error initMidi();
         void deinit();
 
+        /**
+         * Close and reopen only the midi devices, the audio device keeps running.
+         * @return error
+         */
+        Midijo::Error reopenMidi();
+
+        /**
+         * Forget the cached device lists, so the next init enumerates all devices again.
+         */
+        void rescan() { _rescanAudio = true; _rescanMidi = true; }
+
         static void callback(Buffer<double>& in, Buffer<double>& out, CallbackInfo info, Processor& self);
 
+        /**
+         * Run one block of the processing graph, the audio callback forwards to
+         * this. Doesn't touch the audio device, so the graph can also be driven
+         * offline with buffers filled in code.
+         * @param in input endpoints, read only
+         * @param out output endpoints, overwritten
+         */
+        void process(Buffer<double>& in, Buffer<double>& out);
+
         /**
          * Find endpoint given its name.
          * @param name name of endpoint
@@ -49,17 +126,201 @@ namespace Mixijo {
         int find_endpoint(std::string_view name, bool in);
 
         /**
-         * Provides threadsafe access to the input and output channels
-         * by calling the provided lambda after constructing a scoped lock.
+         * Link a midi source to a parameter of a channel.
+         * @param input is the channel an input
+         * @param channel index of the channel
+         * @param name name of the parameter
+         * @param source midi source
+         * @param feedback send value changes back to the midi source
+         */
+        void addMidiLink(bool input, int channel, std::string_view name, MidiSource source, bool feedback = false);
+
+        /**
+         * Remove all midi links, must be called while holding the lock,
+         * as it also invalidates all changes that are still in flight.
+         */
+        void clearMidiLinks();
+
+        /**
+         * Publish changed gains and meter levels to the midi feedback,
+         * only called from the audio thread.
+         * @param frames amount of frames in the current block
+         */
+        void publishFeedback(std::size_t frames);
+
+        /**
+         * Resolve a midi CC through the dispatch table and post
+         * the changes to the audio thread. Also tracks NRPN messages, data
+         * entry for RPNs is ignored.
+         * @param cc controller number
+         * @param value controller value
+         */
+        void handleMidi(int cc, int value);
+
+        /**
+         * Resolve a pitch bend message and post the changes to the audio thread.
+         * @param channel midi channel
+         * @param value 14-bit pitch bend value
+         */
+        void handlePitchBend(int channel, int value);
+
+        /**
+         * Convert a 14-bit controller value to a linear gain,
+         * uses a precomputed lookup table.
+         * @param value 14-bit controller value
+         * @return linear gain
+         */
+        static double controllerGain(int value);
+
+        /**
+         * Apply a parameter change, only called from the audio thread.
+         * @param change parameter change
+         */
+        void apply(const ParameterChange& change);
+
+        /**
+         * Apply all queued parameter changes that are due, only called
+         * from the audio thread.
+         * @param time current position on the audio clock in samples
+         */
+        void applyChanges(std::uint64_t time);
+
+        /**
+         * Stamp the current moment against the audio clock. Events are
+         * delayed by exactly one block, so they land at the same offset
+         * in the next block as they arrived in the current one.
+         * @return position on the audio clock in samples
+         */
+        std::uint64_t timestamp() const;
+
+        /**
+         * Capture the current gains, crosspoints and limiter flags. The audio
+         * thread captures them between two blocks, this waits for that.
+         * @param scene destination
+         */
+        void capture(Scene& scene);
+
+        /**
+         * Recall a scene, the audio thread crossfades to it block by block.
+         * Limiter flags are switched at the start of the crossfade.
+         * @param scene scene to recall
+         * @param ms length of the crossfade in milliseconds, 0 for instant
+         * @return false if the scene doesn't match the channels
+         */
+        bool recall(const Scene& scene, double ms);
+
+        /**
+         * Change the input and output channels. The lambda changes a copy of the graph with
+         * the current parameters, which is laid out and handed to the audio thread at the
+         * start of its next block, this waits for that. The audio thread never waits.
          * @tparam lambda callable that takes the inputs and outputs as args
          */
         void access(std::invocable<Inputs&, Outputs&> auto lambda) {
             std::scoped_lock _{ lock };
-            lambda(inputs, outputs);
+            Scene _parameters;
+            snapshot(_parameters);
+            auto _next = std::make_unique<Graph>(*_graph, _parameters);
+            {
+                View _view{ *this, *_next };
+                lambda(inputs, outputs);
+            }
+            _next->layout(); // Channels or endpoints might have been added
+            publish(std::move(_next));
+        }
+
+        /**
+         * Read the input and output channels, with parameters that are consistent
+         * with each other. The lambda reads a copy of the graph, see access.
+         * @tparam lambda callable that takes the inputs and outputs as args
+         */
+        void read(std::invocable<const Inputs&, const Outputs&> auto lambda) {
+            std::scoped_lock _{ lock };
+            Scene _parameters;
+            snapshot(_parameters);
+            Graph _copy{ *_graph, _parameters };
+            View _view{ *this, _copy };
+            lambda(std::as_const(inputs), std::as_const(outputs));
         }
 
+        /**
+         * Lock or unlock the arena in RAM, see Graph::lockArena.
+         * @param locked lock or unlock
+         */
+        void lockArena(bool locked) { _graph->lockArena(locked); }
+
         Inputs inputs{ *this };
         Outputs outputs{ *this };
-        mutable std::mutex lock;
+        mutable Mutex lock; // Serializes changes to the channels, the audio thread never takes it
+
+        std::vector<MidiMapping> midiMappings{};
+        std::array<std::vector<std::size_t>, 128> midiMap{}; // CC -> index in midiMappings
+        std::unordered_map<int, std::vector<std::size_t>> nrpnMap{};
+        std::vector<std::size_t> pitchBendMap{};
+        SpscQueue<ParameterChange, 1024> changes{};
+        std::size_t generation = 0;
+
+        Feedback feedback{ *this };
+        SpscQueue<ParameterChange, 4096> feedbackChanges{};
+        std::atomic<bool> feedbackGains{ false };
+        std::atomic<bool> feedbackMeters{ false };
+        mutable Mutex midiLock;    // Guards the midi mappings, taken by the midi-in handler
+        mutable Mutex midiOutLock; // Guards the midi-out device, never held with the midi lock
+
+        Analyzer analyzer{};
+
+    private:
+        // Audio clock, published by the audio thread at the start of every block
+        std::atomic<std::uint32_t> _clockSequence{ 0 };
+        std::atomic<std::uint64_t> _clockSample{ 0 };
+        std::atomic<std::uint64_t> _clockFrames{ 0 };
+        std::atomic<std::int64_t> _clockNanos{ 0 };
+
+        // Only touched by the audio thread
+        std::uint64_t _sampleTime = 0;
+        ParameterChange _change{};
+        bool _hasChange = false;
+
+        std::size_t _meterSamples = 0;
+
+        // The graph the audio thread processes, handed to it as a whole, see access. Outside of a block
+        // the controller can stand in for the audio thread, when it isn't processing, see wait.
+        std::unique_ptr<Graph> _graph = std::make_unique<Graph>(); // Owned by the controller, freed after the audio thread moved on
+        Graph* _view = _graph.get(); // What inputs and outputs show, the copy in access and read
+        Graph* _live = _graph.get(); // Only touched by the audio thread
+        std::atomic<Graph*> _next{ nullptr };    // Taken at the start of the next block
+        std::atomic<Scene*> _capture{ nullptr }; // Captured at the end of the next block
+        std::atomic<bool> _processing{ false };  // Held by the audio thread during a block
+
+        // Device lists are cached, only enumerate devices again when set
+        bool _rescanAudio = true;
+        bool _rescanMidi = true;
+
+        // Endpoint name -> id of the opened device, rebuilt when the device is opened
+        string_map<int> _inputEndpoints{};
+        string_map<int> _outputEndpoints{};
+
+        // NRPN state, only touched by the midi thread
+        int _nrpnParameter = 0;
+        int _nrpnMsb = 0;
+        bool _nrpnSelected = false; // Cleared when an RPN is selected
+
+        // Points inputs and outputs at another graph while it lives
+        struct View {
+            Processor& self;
+            Graph* previous;
+            View(Processor& self, Graph& graph) : self(self), previous(self._view) { self._view = &graph; }
+            ~View() { self._view = previous; }
+        };
+
+        void deinitMidi();
+        void indexEndpoints();
+        void publishClock(std::size_t frames);
+        bool running() const;
+        void publish(std::unique_ptr<Graph> next);
+        void wait(const auto& request);
+        void snapshot(Scene& scene);
+        void adopt();
+        void serveCapture();
+        void post(MidiMapping& mapping, int value, std::uint64_t time);
     };
 }
\ No newline at end of file
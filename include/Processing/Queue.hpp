@@ -0,0 +1,166 @@
+#pragma once
+#include "pch.hpp"
+
+namespace Mixijo {
+
+    /**
+     * Bounded lock-free single-producer single-consumer queue. Used to
+     * hand data to and from the audio thread without locking.
+     * @tparam Ty element type
+     * @tparam N capacity, must be a power of 2
+     */
+    template<class Ty, std::size_t N>
+    class SpscQueue {
+        static_assert(N != 0 && (N & (N - 1)) == 0, "Capacity must be a power of 2");
+    public:
+        /**
+         * Push an element, only call this from the producer thread.
+         * @param value element to push
+         * @return false if the queue is full
+         */
+        bool push(const Ty& value) {
+            const std::size_t _write = _writeIndex.load(std::memory_order_relaxed);
+            if (_write - _readIndex.load(std::memory_order_acquire) == N) return false;
+            _data[_write & (N - 1)] = value;
+            _writeIndex.store(_write + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * Pop an element, only call this from the consumer thread.
+         * @param value destination of the popped element
+         * @return false if the queue is empty
+         */
+        bool pop(Ty& value) {
+            const std::size_t _read = _readIndex.load(std::memory_order_relaxed);
+            if (_read == _writeIndex.load(std::memory_order_acquire)) return false;
+            value = _data[_read & (N - 1)];
+            _readIndex.store(_read + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool empty() const {
+            return _readIndex.load(std::memory_order_acquire)
+                == _writeIndex.load(std::memory_order_acquire);
+        }
+
+    private:
+        alignas(64) std::atomic<std::size_t> _writeIndex{ 0 };
+        alignas(64) std::atomic<std::size_t> _readIndex{ 0 };
+        std::array<Ty, N> _data{};
+    };
+
+    /**
+     * Bounded lock-free multi-producer multi-consumer queue, every slot
+     * has a sequence number that tells producers and consumers whose turn
+     * it is, so they never wait on each other.
+     * @tparam Ty element type
+     * @tparam N capacity, must be a power of 2
+     */
+    template<class Ty, std::size_t N>
+    class MpmcQueue {
+        static_assert(N != 0 && (N & (N - 1)) == 0, "Capacity must be a power of 2");
+    public:
+        MpmcQueue() {
+            for (std::size_t i = 0; i < N; ++i)
+                _cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        /**
+         * Push an element, can be called from any thread.
+         * @param value element to push
+         * @return false if the queue is full
+         */
+        bool push(const Ty& value) {
+            Cell* _cell = nullptr;
+            std::size_t _write = _writeIndex.load(std::memory_order_relaxed);
+            while (true) {
+                _cell = &_cells[_write & (N - 1)];
+                const std::size_t _sequence = _cell->sequence.load(std::memory_order_acquire);
+                const auto _diff = static_cast<std::ptrdiff_t>(_sequence - _write);
+                if (_diff == 0) {
+                    if (_writeIndex.compare_exchange_weak(_write, _write + 1, std::memory_order_relaxed)) break;
+                } else if (_diff < 0) return false;
+                else _write = _writeIndex.load(std::memory_order_relaxed);
+            }
+            _cell->value = value;
+            _cell->sequence.store(_write + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * Pop an element, can be called from any thread.
+         * @param value destination of the popped element
+         * @return false if the queue is empty
+         */
+        bool pop(Ty& value) {
+            Cell* _cell = nullptr;
+            std::size_t _read = _readIndex.load(std::memory_order_relaxed);
+            while (true) {
+                _cell = &_cells[_read & (N - 1)];
+                const std::size_t _sequence = _cell->sequence.load(std::memory_order_acquire);
+                const auto _diff = static_cast<std::ptrdiff_t>(_sequence - (_read + 1));
+                if (_diff == 0) {
+                    if (_readIndex.compare_exchange_weak(_read, _read + 1, std::memory_order_relaxed)) break;
+                } else if (_diff < 0) return false;
+                else _read = _readIndex.load(std::memory_order_relaxed);
+            }
+            value = _cell->value;
+            _cell->sequence.store(_read + N, std::memory_order_release);
+            return true;
+        }
+
+    private:
+        struct Cell {
+            std::atomic<std::size_t> sequence{ 0 };
+            Ty value{};
+        };
+
+        alignas(64) std::atomic<std::size_t> _writeIndex{ 0 };
+        alignas(64) std::atomic<std::size_t> _readIndex{ 0 };
+        std::array<Cell, N> _cells{};
+    };
+
+    /**
+     * Lock-free triple buffer, hands the latest value from one writer
+     * thread to one reader thread. The writer fills the back buffer and
+     * publishes it, the reader always gets the newest published buffer,
+     * neither ever waits and values the reader missed are skipped.
+     * @tparam Ty element type
+     */
+    template<class Ty>
+    class TripleBuffer {
+    public:
+        /**
+         * Buffer to fill before publishing, only call this from the writer thread.
+         * @return back buffer
+         */
+        Ty& write() { return _buffers[_back]; }
+
+        /**
+         * Publish the back buffer, only call this from the writer thread.
+         */
+        void publish() {
+            _back = _middle.exchange(_back | Fresh, std::memory_order_acq_rel) & Index;
+        }
+
+        /**
+         * Latest published value, only call this from the reader thread.
+         * @return front buffer
+         */
+        const Ty& read() {
+            if (_middle.load(std::memory_order_relaxed) & Fresh)
+                _front = _middle.exchange(_front, std::memory_order_acq_rel) & Index;
+            return _buffers[_front];
+        }
+
+    private:
+        constexpr static std::uint8_t Index = 3; // Mask of the buffer index in _middle
+        constexpr static std::uint8_t Fresh = 4; // Set when the middle buffer wasn't read yet
+
+        std::array<Ty, 3> _buffers{};
+        std::uint8_t _back = 0;
+        alignas(64) std::uint8_t _front = 1;
+        alignas(64) std::atomic<std::uint8_t> _middle{ 2 };
+    };
+}
\ No newline at end of file
@@ -0,0 +1,23 @@
+#pragma once
+#include "pch.hpp"
+
+namespace Mixijo {
+
+    /**
+     * One line of routing.txt, like "Mic:[gain=1,limiter=0]:[Speakers,Stream]". Outputs
+     * only have the first two parts, inputs also list the outputs they're routed to.
+     * Only refers to the line, so it can't outlive it.
+     */
+    struct RoutingLine {
+        std::string_view channel;
+        bool input = false;
+        std::vector<std::pair<std::string_view, double>> settings{}; // See Channel::setSetting
+        std::vector<std::string_view> outputs{};                     // Names of the outputs an input is routed to
+
+        /**
+         * @param line line of routing.txt
+         * @return nothing for comments and lines that aren't a channel
+         */
+        static std::optional<RoutingLine> parse(std::string_view line);
+    };
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "pch.hpp"
+
+namespace Mixijo {
+
+    /**
+     * Snapshot of all gains, crosspoints and limiter flags of the mixer,
+     * stored in a compact binary format so it can be recalled without parsing.
+     */
+    struct Scene {
+        constexpr static std::uint32_t magic = 0x4353584D; // "MXSC"
+        constexpr static std::uint32_t version = 1;
+
+        std::uint64_t layout = 0; // Hash of the channel layout the scene was captured with
+        std::vector<double> inputGains{};
+        std::vector<double> outputGains{};
+        std::vector<std::uint8_t> inputLimiters{};
+        std::vector<std::uint8_t> outputLimiters{};
+        std::vector<double> levels{}; // Crosspoints, outputs per input
+
+        /**
+         * @return binary representation of the scene
+         */
+        std::string serialize() const;
+
+        /**
+         * Read a scene from its binary representation.
+         * @param data binary data
+         * @return scene, nothing if the data is invalid
+         */
+        static std::optional<Scene> deserialize(std::string_view data);
+    };
+}
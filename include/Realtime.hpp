@@ -0,0 +1,107 @@
+#pragma once
+#include "pch.hpp"
+
+namespace Mixijo {
+
+    /**
+     * Checks that the audio thread never allocates, frees or locks a
+     * mutex while it is processing. Only active when built with
+     * MIXIJO_RT_CHECK, then operator new and delete are replaced, and Mutex
+     * reports every lock. Violations are recorded with their
+     * stack trace, report() logs them on another thread. Blocking system
+     * calls aren't intercepted.
+     */
+    class Realtime {
+    public:
+        constexpr static std::size_t MaxViolations = 64; // Only the first ones are kept with their stack trace
+
+        /**
+         * Marks the calling thread as realtime until destroyed, use MIXIJO_REALTIME.
+         */
+        class Scope {
+        public:
+            Scope();
+            ~Scope();
+
+        private:
+            bool _previous;
+        };
+
+        /**
+         * Allows everything on a realtime thread until destroyed, for what it only
+         * does once or when settings changed, use MIXIJO_REALTIME_ALLOW.
+         */
+        class Allow {
+        public:
+            Allow();
+            ~Allow();
+
+        private:
+            bool _previous;
+        };
+
+        /**
+         * Record a violation if the calling thread is realtime.
+         * @param what what the thread shouldn't have done
+         */
+        static void check(const char* what);
+
+        /**
+         * Log the violations that were recorded since the last report.
+         * @param log called with every new violation
+         * @return total number of violations
+         */
+        static std::size_t report(const std::function<void(std::string_view)>& log);
+
+        /**
+         * @return total number of violations
+         */
+        static std::size_t violations() { return _count.load(std::memory_order_relaxed); }
+
+    private:
+        struct Violation {
+            const char* what;
+            std::string trace;
+        };
+
+        static std::mutex _lock;
+        static std::vector<Violation> _violations;
+        static std::atomic<std::size_t> _count;
+        static std::size_t _reported;
+        static thread_local bool _realtime;
+        static thread_local bool _recording; // Recording allocates, don't record that
+    };
+
+#ifdef MIXIJO_RT_CHECK
+    /**
+     * Mutex that records a violation every time the audio thread locks it,
+     * even when it's free, it could have had to wait. try_lock never waits,
+     * so it isn't recorded. Use MIXIJO_REALTIME_ALLOW for locks that are taken on purpose.
+     */
+    class Mutex {
+    public:
+        void lock() {
+            Realtime::check("locking a mutex");
+            _mutex.lock();
+        }
+
+        bool try_lock() { return _mutex.try_lock(); }
+        void unlock() { _mutex.unlock(); }
+
+    private:
+        std::mutex _mutex;
+    };
+#else
+    using Mutex = std::mutex;
+#endif
+}
+
+#ifdef MIXIJO_RT_CHECK
+#define MIXIJO_REALTIME_JOIN2(a, b) a##b
+#define MIXIJO_REALTIME_JOIN(a, b) MIXIJO_REALTIME_JOIN2(a, b)
+#define MIXIJO_REALTIME() ::Mixijo::Realtime::Scope MIXIJO_REALTIME_JOIN(_realtimeScope, __LINE__){}
+#define MIXIJO_REALTIME_ALLOW() ::Mixijo::Realtime::Allow MIXIJO_REALTIME_JOIN(_realtimeAllow, __LINE__){}
+#else
+#define MIXIJO_REALTIME() ((void)0)
+#define MIXIJO_REALTIME_ALLOW() ((void)0)
+#endif
@@ -0,0 +1,55 @@
+#pragma once
+#include "pch.hpp"
+
+namespace Mixijo {
+
+    /**
+     * Scheduling of the engine threads. The audio thread joins the "Pro Audio"
+     * MMCSS task, the other engine threads get a higher priority. Threads can
+     * be pinned to cpus, and the engine memory can be locked in RAM so the
+     * audio thread never takes a page fault. Every thread applies the settings
+     * itself, the next time it calls apply after they changed.
+     */
+    class Scheduling {
+    public:
+        enum Thread { Audio, Main, Feedback, Analyzer, Threads };
+
+        struct Settings {
+            bool realtime = true;                          // MMCSS and higher priorities
+            std::array<std::uint64_t, Threads> affinity{}; // Cpu mask per thread, 0 for any cpu
+            bool lockMemory = false;                       // Lock the engine memory in RAM
+        };
+
+        /**
+         * Use new settings, the threads pick them up when they call apply.
+         * @param settings settings
+         */
+        static void configure(const Settings& settings);
+
+        /**
+         * Apply the settings to the calling thread if they changed, cheap
+         * enough to call from the audio callback.
+         * @param thread which engine thread is calling
+         */
+        static void apply(Thread thread);
+
+        /**
+         * Lock memory in RAM when lockMemory is set, this also faults it in.
+         * @param data start of the memory
+         * @param bytes size of the memory
+         * @return true if the memory was locked
+         */
+        static bool lock(const void* data, std::size_t bytes);
+        static void unlock(const void* data, std::size_t bytes);
+
+        static bool lockMemory() { return _lockMemory.load(std::memory_order_relaxed); }
+
+        constexpr static std::array<const char*, Threads> Names{ "audio", "main", "feedback", "analyzer" };
+
+    private:
+        static std::atomic<bool> _realtime;
+        static std::atomic<bool> _lockMemory;
+        static std::array<std::atomic<std::uint64_t>, Threads> _affinity;
+        static std::atomic<std::size_t> _generation;
+    };
+}
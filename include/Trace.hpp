@@ -0,0 +1,75 @@
+#pragma once
+#include "pch.hpp"
+
+namespace Mixijo {
+
+    /**
+     * Records scoped trace zones, and dumps them as Chrome trace events, which
+     * can be opened in chrome://tracing or ui.perfetto.dev. Every thread records
+     * into its own lock-free ring buffer, only the first zone of a thread takes
+     * a lock to claim a buffer. Use the MIXIJO_TRACE macros, they compile
+     * to nothing unless MIXIJO_TRACING is defined.
+     */
+    class Trace {
+    public:
+        constexpr static std::size_t Capacity = 16384; // Zones kept per thread, the oldest are overwritten
+
+        /**
+         * Records the time between its construction and destruction.
+         */
+        class Zone {
+        public:
+            Zone(const char* name);
+            ~Zone();
+
+        private:
+            const char* _name;
+            std::int64_t _begin;
+        };
+
+        /**
+         * Name the calling thread in the dumped trace.
+         * @param name name, must outlive the trace
+         */
+        static void thread(const char* name);
+
+        /**
+         * Serialize the recorded zones of all threads, threads keep
+         * recording while this runs.
+         * @return trace in the Chrome trace event format
+         */
+        static std::string dump();
+
+    private:
+        struct Slot {
+            std::atomic<const char*> name{ nullptr };
+            std::atomic<std::int64_t> begin{ 0 }; // Nanoseconds since the start of the trace
+            std::atomic<std::int64_t> end{ 0 };
+        };
+
+        struct Buffer {
+            std::size_t id = 0;
+            std::atomic<bool> used{ false }; // Owned by a running thread
+            std::atomic<const char*> name{ nullptr };
+            std::atomic<std::size_t> written{ 0 };
+            std::array<Slot, Capacity> slots{};
+        };
+
+        static std::mutex _lock;
+        static std::vector<std::unique_ptr<Buffer>> _buffers;
+        static const std::chrono::steady_clock::time_point _start;
+
+        static Buffer& local();
+        static std::int64_t now();
+    };
+}
+
+#ifdef MIXIJO_TRACING
+#define MIXIJO_TRACE_JOIN2(a, b) a##b
+#define MIXIJO_TRACE_JOIN(a, b) MIXIJO_TRACE_JOIN2(a, b)
+#define MIXIJO_TRACE(name) ::Mixijo::Trace::Zone MIXIJO_TRACE_JOIN(_traceZone, __LINE__){ name }
+#define MIXIJO_TRACE_THREAD(name) ::Mixijo::Trace::thread(name)
+#else
+#define MIXIJO_TRACE(name) ((void)0)
+#define MIXIJO_TRACE_THREAD(name) ((void)0)
+#endif
@@ -3,7 +3,7 @@
 
 namespace Mixijo {
 
-    constexpr std::array NUMBERS{ "0",
+    inline constexpr std::array NUMBERS{ "0",
           "1",  "2",  "3",  "4",  "5",  "6",  "7",  "8",  "9", "10",
          "11", "12", "13", "14", "15", "16", "17", "18", "19", "20",
          "21", "22", "23", "24", "25", "26", "27", "28", "29", "30",
@@ -72,6 +72,30 @@ namespace Mixijo {
      */
     constexpr bool oneOf(char c, std::string_view cs) { return cs.find(c) != std::string_view::npos; }
 
+    /**
+     * Read a whole file with a single read.
+     * @param path path of the file
+     * @return content of the file, nothing if it can't be opened
+     */
+    inline std::optional<std::string> readFile(const std::filesystem::path& path) {
+        std::ifstream _file{ path, std::ios::binary | std::ios::ate };
+        if (!_file.is_open()) return {};
+        const std::streamoff _size = _file.tellg();
+        if (_size < 0) return {}; // Not a regular file, or the size can't be known
+        std::string _content(static_cast<std::size_t>(_size), '\0');
+        _file.seekg(0);
+        if (!_file.read(_content.data(), _content.size())) return {};
+        return _content;
+    }
+
+    /**
+     * Transparent string hash, so a string_map can be searched with a string_view.
+     */
+    struct string_hash : std::hash<std::string_view> { using is_transparent = std::true_type; };
+
+    template<class Ty>
+    using string_map = std::unordered_map<std::string, Ty, string_hash, std::equal_to<>>;
+
     class json {
         struct object_hash : std::hash<std::string_view> { using is_transparent = std::true_type; };
     public:
@@ -87,12 +111,13 @@ namespace Mixijo {
     private:
         using value = std::variant<floating, integral, unsigned_integral, string, boolean, array, object, null>;
         template<class Ty> struct type_alias { using type = Ty; };
-        template<> struct type_alias<float> { using type = floating; };
-        template<> struct type_alias<bool> { using type = boolean; };
-        template<> struct type_alias<std::string_view> { using type = string; };
+        // Constrained instead of explicit specializations, those aren't allowed in a class on every compiler
+        template<std::same_as<float> Ty> struct type_alias<Ty> { using type = floating; };
+        template<std::same_as<bool> Ty> struct type_alias<Ty> { using type = boolean; };
+        template<std::same_as<std::string_view> Ty> struct type_alias<Ty> { using type = string; };
         template<std::size_t N> struct type_alias<char[N]> { using type = string; };
         template<std::signed_integral Ty> struct type_alias<Ty> { using type = integral; };
-        template<std::unsigned_integral Ty> struct type_alias<Ty> { using type = unsigned_integral; };
+        template<std::unsigned_integral Ty> requires (!std::same_as<Ty, bool>) struct type_alias<Ty> { using type = unsigned_integral; };
         value _value;
     public:
         template<class Ty = null>
@@ -103,6 +128,7 @@ namespace Mixijo {
         template<class Ty> const Ty& as() const { return std::get<Ty>(_value); }
         auto type() const { return static_cast<value_type>(_value.index()); }
         bool is(value_type t) const { return t == type(); }
+        bool operator==(const json& other) const { return _value == other._value; }
 
         /**
          * Check if object contains key.
@@ -123,7 +149,7 @@ namespace Mixijo {
          */
         json& operator[](std::string_view index) {
             if (is(Null)) _value = object{};
-            else if (!is(Object)) throw std::exception("Not an object.");
+            else if (!is(Object)) throw std::runtime_error("Not an object.");
             for (auto& [key, val] : as<object>())
                 if (key == index) return val;
             return as<object>().emplace_back(std::pair{ std::string{ index }, json{} }).second;
@@ -137,7 +163,7 @@ namespace Mixijo {
          */
         json& operator[](std::size_t index) {
             if (is(Null)) _value = array{};
-            else if (!is(Array)) throw std::exception("Not an array.");
+            else if (!is(Array)) throw std::runtime_error("Not an array.");
             if (as<array>().size() <= index) as<array>().resize(index + 1);
             return as<array>()[index];
         }
@@ -149,7 +175,7 @@ namespace Mixijo {
          */
         template<class Ty> json& emplace(const Ty& val) {
             if (is(Null)) _value = array{};
-            else if (!is(Array)) throw std::exception("Not an array.");
+            else if (!is(Array)) throw std::runtime_error("Not an array.");
             return std::get<array>(_value).emplace_back(val);
         }
 
@@ -161,148 +187,217 @@ namespace Mixijo {
         }
 
         /**
-         * Parse json from a string.
+         * Parse json from a string into a DOM.
          * @param val json string
          * @return optional, value if correct json
          */
-        static std::optional<json> parse(std::string_view val) {
-            if ((val = trim(val)).empty()) return {};
-            std::optional<json> _result = {};
-            if ((_result = parseJsonObject(val)) && trim(val).empty()) return _result;
-            if ((_result = parseJsonArray(val)) && trim(val).empty()) return _result;
-            return {};
-        }
+        static std::optional<json> parse(std::string_view val);
 
-    private:
-        static std::string removeDoubleEscapes(std::string_view str) {
-            std::string _str{ str };
-            for (auto _i = _str.begin(); _i != _str.end();)
-                if (*_i == '\\') ++(_i = _str.erase(_i)); else ++_i;
-            return _str;
+        /**
+         * Streaming parse of json, calls the handler for every token instead
+         * of building a DOM. All string views point into val, strings are
+         * not unescaped, use unescape() when the escaped flag is set. The handler
+         * needs to have these member functions:
+         *   beginObject(), endObject(), beginArray(), endArray(),
+         *   key(std::string_view, bool escaped), value(std::string_view, bool escaped),
+         *   value(floating), value(integral), value(unsigned_integral), value(boolean), value(null)
+         * @param val json string, top level has to be an object or array
+         * @param handler token handler
+         * @return true if correct json
+         */
+        template<class Handler>
+        static bool parse(std::string_view val, Handler& handler) {
+            reader<Handler> _reader{ val.data(), val.data() + val.size(), handler };
+            _reader.skip();
+            if (_reader.pos == _reader.end || !oneOf(*_reader.pos, "{[")) return false;
+            if (!_reader.value()) return false;
+            _reader.skip();
+            return _reader.pos == _reader.end;
         }
 
-        static bool consume(std::string_view& val, char c, bool empty = false) {
-            if ((val = trim(val)).empty() || !val.starts_with(c)) return false;
-            return !(val = trim(val.substr(1))).empty() || empty;
+        /**
+         * Remove the escaping backslashes from a string.
+         * @param str escaped string
+         * @return unescaped string
+         */
+        static std::string unescape(std::string_view str) {
+            std::string _str;
+            _str.reserve(str.size());
+            for (std::size_t i = 0; i < str.size(); ++i) {
+                if (str[i] == '\\' && ++i == str.size()) break;
+                _str.push_back(str[i]);
+            }
+            return _str;
         }
 
-        static bool consume(std::string_view& val, std::string_view word) {
-            return val.starts_with(word) ? val = val.substr(word.size()), true : false;
-        }
+    private:
+        template<class Handler>
+        struct reader {
+            const char* pos;
+            const char* end;
+            Handler& handler;
+            std::size_t depth = 0;
 
-        static std::optional<json> parseJsonBool(std::string_view& val) {
-            return consume(val, "true") ? true
-                : consume(val, "false") ? false : std::optional<json>{};
-        }
+            constexpr static std::size_t maxDepth = 256;
 
-        static std::optional<json> parseJsonNull(std::string_view& val) {
-            return consume(val, "null") ? nullptr : std::optional<json>{};
-        }
+            void skip() { while (pos != end && oneOf(*pos, " \t\n\r\f\v")) ++pos; }
+            bool digit() const { return pos != end && *pos >= '0' && *pos <= '9'; }
+            bool consume(char c) { return skip(), pos != end && *pos == c ? ++pos, true : false; }
 
-        static std::optional<json> parseJsonNumber(std::string_view& val) {
-            std::string_view _json = val;
-            std::size_t _size = 0ull;
-            bool _floating = false, _signed = false;
-            auto _isDigit = [&] { return oneOf(_json.front(), "0123456789"); };
-            auto _consume = [&] { return ++_size, !(_json = _json.substr(1)).empty(); };
-            auto _consumeDigits = [&] {
-                if (!_isDigit()) return false;
-                while (_isDigit()) if (!_consume()) return false;
-                return true;
-            };
-
-            if (_signed = _json.starts_with('-'))
-                if (!_consume()) return {};
-
-            if (_json.starts_with('0')) {      // when leading 0
-                if (!_consume()) return {}; // 
-                if (_isDigit()) return {};     // can't be followed by digit
+            bool consume(std::string_view word) {
+                if (static_cast<std::size_t>(end - pos) < word.size()) return false;
+                if (std::string_view{ pos, word.size() } != word) return false;
+                return pos += word.size(), true;
             }
-            else if (!_consumeDigits()) return {};
 
-            if (_floating = _json.starts_with('.')) {
-                if (!_consume()) return {};
-                if (!_consumeDigits()) return {};
+            bool value() {
+                skip();
+                if (pos == end) return false;
+                switch (*pos) {
+                case '{': return object();
+                case '[': return array();
+                case '"': {
+                    std::string_view _value;
+                    bool _escaped = false;
+                    if (!string(_value, _escaped)) return false;
+                    return handler.value(_value, _escaped), true;
+                }
+                case 't': return consume("true") ? handler.value(true), true : false;
+                case 'f': return consume("false") ? handler.value(false), true : false;
+                case 'n': return consume("null") ? handler.value(nullptr), true : false;
+                default: return number();
+                }
             }
 
-            if (oneOf(_json.front(), "eE")) {
-                if (!_consume()) return {};
-                if (oneOf(_json.front(), "-+") && !_consume()) return {};
-                if (!_consumeDigits()) return {};
+            bool string(std::string_view& result, bool& escaped) {
+                const char* _begin = ++pos; // skip '"'
+                for (; pos != end; ++pos) {
+                    if (*pos == '"') {
+                        result = { _begin, static_cast<std::size_t>(pos++ - _begin) };
+                        return true;
+                    } else if (*pos == '\\') {
+                        escaped = true;
+                        if (++pos == end) return false;
+                    }
+                }
+                return false;
             }
 
-            _json = val.substr(0, _size);
-            auto _parse = [&]<class Ty>(Ty val) {
-                std::from_chars(_json.data(), _json.data() + _json.size(), val);
-                return json{ val };
-            };
-            val = val.substr(_size);
-            return _floating ? _parse(0.0) : _signed ? _parse(0ll) : _parse(0ull);
-        }
+            bool number() {
+                const char* _begin = pos;
+                bool _floating = false, _signed = false;
+                if (*pos == '-') _signed = true, ++pos;
+                if (pos != end && *pos == '0') ++pos; // leading 0 can't be followed by digit
+                else if (digit()) while (digit()) ++pos;
+                else return false;
 
-        static std::optional<json> parseJsonString(std::string_view& val) {
-            std::string_view _json = val, _result = _json;
-            if (!consume(_json, '"')) return {};                 // parse '"'
-            if (consume(_json, '"')) return val = _json, "";     // empty string if parse '"'
-            for (std::size_t _offset = 1ull;;) {                 //
-                std::size_t _index = _json.find_first_of('"');   // find next '"'
-                if (_index == std::string_view::npos) return {}; // if not exist, invalid string
-                if (_result[_offset + _index - 1] == '\\') {     // if escaped
-                    std::size_t _check = _offset + _index - 1;   //
-                    std::size_t _count = 0;                      //
-                    while (_result[_check] == '\\') {            // count how many there are
-                        ++_count;                                //
-                        if (_check-- == 0) break;                //
-                    }                                            // if even amount, the '\'
-                    if (_count % 2 == 0) {                       // itself is escaped, so this is the end
-                        val = _result.substr(_offset + _index + 1);  //   remove from remainder
-                        return removeDoubleEscapes(_result.substr(1, _offset + _index - 1));
-                    }
-                    else {
-                        _offset += _index + 1;                       //   add offset
-                        _json = _result.substr(_offset);             //   remove suffix from search
-                    }
+                if (pos != end && *pos == '.') {
+                    _floating = true, ++pos;
+                    if (!digit()) return false;
+                    while (digit()) ++pos;
                 }
-                else {                                         // else not escaped
-                    val = _result.substr(_offset + _index + 1);  //   remove from remainder
-                    return removeDoubleEscapes(_result.substr(1, _offset + _index - 1));
+
+                if (pos != end && oneOf(*pos, "eE")) {
+                    _floating = true, ++pos;
+                    if (pos != end && oneOf(*pos, "-+")) ++pos;
+                    if (!digit()) return false;
+                    while (digit()) ++pos;
                 }
+
+                auto _parse = [&]<class Ty>(Ty val) {
+                    std::from_chars(_begin, pos, val);
+                    return handler.value(val), true;
+                };
+                return _floating ? _parse(floating{}) : _signed ? _parse(integral{}) : _parse(unsigned_integral{});
             }
-        }
 
-        static std::optional<json> parseJsonArray(std::string_view& val) {
-            std::string_view _json = val;
-            if (!consume(_json, '[')) return {};                      // parse '['
-            std::optional<json> _result = array{}, _value = {};       // 
-            while (_value = parseJsonValue(_json)) {                  // try parse value
-                _result.value().emplace(_value.value());              // add value to result
-                if (!consume(_json, ',')) break;                      // if no comma, break
-            }                                                         // 
-            if (!consume(_json, ']', true)) return {};                // parse ']'
-            return val = _json, _result; // on success, save to val, return result
-        }
+            bool array() {
+                ++pos; // skip '['
+                if (++depth > maxDepth) return false;
+                handler.beginArray();
+                if (!consume(']')) {
+                    do if (!value()) return false;
+                    while (consume(','));
+                    if (!consume(']')) return false;
+                }
+                handler.endArray();
+                return --depth, true;
+            }
 
-        static std::optional<json> parseJsonObject(std::string_view& val) {
-            std::string_view _json = val;
-            if (!consume(_json, '{')) return {};                       // parse '{'
-            std::optional<json> _result = object{}, _value = {};       //
-            while (_value = parseJsonString(_json)) {                  // parse key
-                std::string _key = _value.value().as<string>();        // 
-                if (!consume(_json, ':')) return {};                   // parse ':'
-                if (!(_value = parseJsonValue(_json))) return {};      // parse value
-                _result.value()[_key] = _value.value();                // add to object
-                if (!consume(_json, ',')) break;                       // if no comma, break
-            }                                                          //
-            if (!consume(_json, '}', true)) return {};                 // parse '}'
-            return val = _json, _result; // on success, save to val, return result
-        }
+            bool object() {
+                ++pos; // skip '{'
+                if (++depth > maxDepth) return false;
+                handler.beginObject();
+                if (!consume('}')) {
+                    do {
+                        std::string_view _key;
+                        bool _escaped = false;
+                        if (skip(), pos == end || *pos != '"') return false;
+                        if (!string(_key, _escaped)) return false;
+                        handler.key(_key, _escaped);
+                        if (!consume(':')) return false;
+                        if (!value()) return false;
+                    } while (consume(','));
+                    if (!consume('}')) return false;
+                }
+                handler.endObject();
+                return --depth, true;
+            }
+        };
+
+        struct builder;
+    };
+
+    /**
+     * Handler that builds a DOM from the streaming json parser.
+     */
+    struct json::builder {
+        constexpr static std::size_t indexedKeys = 8; // Larger objects find duplicate keys through a hash index
 
-        static std::optional<json> parseJsonValue(std::string_view& val) {
-            std::optional<json> _result = {};
-            return (_result = parseJsonString(val)) || (_result = parseJsonArray(val))
-                || (_result = parseJsonObject(val)) || (_result = parseJsonBool(val))
-                || (_result = parseJsonNumber(val)) || (_result = parseJsonNull(val))
-                ? _result : std::optional<json>{};
+        struct level {
+            json* value;
+            string_map<std::size_t> keys{}; // Key -> index in the object, only built for large objects
+        };
+
+        json root{};
+        std::vector<level> stack{};
+        std::string_view pendingKey{};
+        bool pendingEscaped = false;
+
+        json& next() {
+            if (stack.empty()) return root;
+            level& _parent = stack.back();
+            if (_parent.value->is(Array)) return _parent.value->as<array>().emplace_back();
+            auto& _object = _parent.value->as<object>();
+            std::string _key = pendingEscaped ? unescape(pendingKey) : std::string{ pendingKey };
+            if (_object.size() < indexedKeys) { // Duplicate key, last one wins
+                for (auto& [_existing, _value] : _object)
+                    if (_existing == _key) return _value = json{};
+            } else {
+                if (_parent.keys.empty())
+                    for (std::size_t i = 0; i < _object.size(); ++i) _parent.keys.emplace(_object[i].first, i);
+                auto [_it, _added] = _parent.keys.emplace(_key, _object.size());
+                if (!_added) return _object[_it->second].second = json{};
+            }
+            return _object.emplace_back(std::piecewise_construct, std::forward_as_tuple(std::move(_key)), std::forward_as_tuple()).second;
         }
+
+        void beginObject() { json& _value = next(); _value = object{}; stack.push_back({ &_value }); }
+        void endObject() { stack.pop_back(); }
+        void beginArray() { json& _value = next(); _value = array{}; stack.push_back({ &_value }); }
+        void endArray() { stack.pop_back(); }
+        void key(std::string_view key, bool escaped) { pendingKey = key, pendingEscaped = escaped; }
+        void value(std::string_view val, bool escaped) { next() = escaped ? unescape(val) : std::string{ val }; }
+        void value(floating val) { next() = val; }
+        void value(integral val) { next() = val; }
+        void value(unsigned_integral val) { next() = val; }
+        void value(boolean val) { next() = val; }
+        void value(null val) { next() = val; }
     };
+
+    inline std::optional<json> json::parse(std::string_view val) {
+        builder _builder;
+        if (!parse(val, _builder)) return {};
+        return std::move(_builder.root);
+    }
 }
\ No newline at end of file
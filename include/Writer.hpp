@@ -0,0 +1,66 @@
+#pragma once
+#include "pch.hpp"
+
+namespace Mixijo {
+
+    /**
+     * Writes files on a background thread. Bursts of writes to the same
+     * file are coalesced, and files are replaced atomically, so a crash
+     * never leaves a half-written file behind.
+     */
+    class Writer {
+    public:
+        using Serializer = std::function<std::string(void)>;
+
+        /**
+         * @param debounce time to wait for more writes before writing a file
+         */
+        Writer(std::chrono::milliseconds debounce = std::chrono::milliseconds(250));
+        ~Writer();
+
+        void start();
+        void stop();
+
+        /**
+         * Queue a write, replaces any pending write to the same file.
+         * @param path file to write
+         * @param serializer creates the content, called on the writer thread
+         */
+        void post(const std::filesystem::path& path, Serializer serializer);
+
+        /**
+         * Write all pending files right away, and wait until they're written.
+         */
+        void flush();
+
+        /**
+         * Replace a file atomically by writing to a temporary file,
+         * syncing it to disk, and renaming it over the original.
+         * @param path file to write
+         * @param content content of the file
+         * @return true on success
+         */
+        static bool writeAtomic(const std::filesystem::path& path, std::string_view content);
+
+    private:
+        struct Pending {
+            std::filesystem::path path;
+            Serializer serializer;
+        };
+
+        std::chrono::milliseconds _debounce;
+        std::thread _thread{};
+        std::mutex _lock{};
+        std::condition_variable _condition{};
+        std::condition_variable _written{};
+        std::vector<Pending> _pending{};
+        std::chrono::steady_clock::time_point _deadline{};
+        std::chrono::steady_clock::time_point _firstPost{};
+        bool _running = false;
+        bool _flush = false;
+        bool _writing = false;
+
+        void run();
+        void writeAll(std::unique_lock<std::mutex>& guard);
+    };
+}
@@ -1,5 +1,9 @@
 #pragma once
 
+#ifdef MIXIJO_STANDALONE
+// Only the engine code, for the tests and benchmarks, see tests/Standalone.hpp
+#include "Standalone.hpp"
+#else
 #include "Guijo/Guijo.hpp"
 #include "Midijo/Midijo.hpp"
 #include "Audijo/Audijo.hpp"
@@ -7,6 +11,7 @@
 using namespace Midijo;
 using namespace Guijo;
 using namespace Audijo;
+#endif
 
 #define db2lin(db) std::powf(10.0f, 0.05 * (db))
 #define lin2db(lin) (20.0f * std::log10(std::max((double)(lin), 0.000000000001)))
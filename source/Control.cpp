@@ -0,0 +1,90 @@
+#include "Control.hpp"
+#include "Controller.hpp"
+
+namespace Mixijo {
+
+    Control::Control(std::string name, Handler handler)
+        : _name(std::move(name)), _handler(std::move(handler))
+    {}
+
+    Control::~Control() { stop(); }
+
+    void Control::start() {
+        if (_running.exchange(true)) return;
+        _stopped = false;
+        _thread = std::thread{ [this] { run(); _stopped = true; } };
+    }
+
+    void Control::stop() {
+        if (!_running.exchange(false)) return;
+        // The thread blocks on the pipe, cancel until it notices we're stopping,
+        // and answer any command it might be waiting for
+        while (!_stopped) {
+            CancelSynchronousIo(_thread.native_handle());
+            handle();
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        _thread.join();
+    }
+
+    void Control::handle() {
+        std::unique_lock _guard{ _lock };
+        if (_requests.empty()) return;
+        while (!_requests.empty()) {
+            Request* _request = _requests.front();
+            _requests.pop_front();
+            _guard.unlock();
+            std::string _answer = _running ? _handler(_request->command) : "error: stopping";
+            _guard.lock();
+            _request->answer = std::move(_answer);
+            _request->done = true;
+        }
+        _guard.unlock();
+        _condition.notify_all();
+    }
+
+    std::string Control::request(std::string command) {
+        Request _request{ std::move(command) };
+        std::unique_lock _guard{ _lock };
+        _requests.push_back(&_request);
+        _condition.wait(_guard, [&] { return _request.done; });
+        return std::move(_request.answer);
+    }
+
+    void Control::run() {
+        const std::string _path = "\\\\.\\pipe\\" + _name;
+        while (_running) {
+            HANDLE _pipe = CreateNamedPipeA(_path.c_str(), PIPE_ACCESS_DUPLEX,
+                PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS, 1, 4096, 4096, 0, nullptr);
+            if (_pipe == INVALID_HANDLE_VALUE) {
+                Controller::errline("Failed to create the control pipe (", _path, ")");
+                return;
+            }
+
+            if (ConnectNamedPipe(_pipe, nullptr) || GetLastError() == ERROR_PIPE_CONNECTED) serve(_pipe);
+            DisconnectNamedPipe(_pipe);
+            CloseHandle(_pipe);
+        }
+    }
+
+    void Control::serve(void* pipe) {
+        constexpr std::size_t _maxLine = 4096;
+        std::string _buffer;
+        char _data[512];
+        DWORD _read = 0;
+        while (_running && ReadFile(pipe, _data, sizeof(_data), &_read, nullptr) && _read > 0) {
+            _buffer.append(_data, _read);
+            for (std::size_t _end; (_end = _buffer.find('\n')) != std::string::npos;) {
+                std::string _command = _buffer.substr(0, _end);
+                _buffer.erase(0, _end + 1);
+                if (!_command.empty() && _command.back() == '\r') _command.pop_back();
+                if (_command.empty()) continue;
+
+                const std::string _answer = request(std::move(_command)) + "\n";
+                DWORD _written = 0;
+                if (!WriteFile(pipe, _answer.data(), static_cast<DWORD>(_answer.size()), &_written, nullptr)) return;
+            }
+            if (_buffer.size() > _maxLine) return; // Not a line based client, disconnect
+        }
+    }
+}
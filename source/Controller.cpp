@@ -1,6 +1,7 @@
 #include "Controller.hpp"
 #include "Gui/Mixer.hpp"
 #include "Gui/Channel.hpp"
+#include "Processing/Routing.hpp"
 #include "Utils.hpp"
 #include "resource.h"
 
@@ -12,7 +13,8 @@ namespace Mixijo {
     std::string Controller::audioDevice{};
     std::string Controller::midiinDevice{};
     std::string Controller::midioutDevice{};
-    std::vector<std::pair<int, std::string>> Controller::buttons{};
+    std::vector<Button> Controller::buttons{};
+    SpscQueue<int, 64> Controller::presses{};
     int Controller::selectedChannel = -1;
     bool Controller::selectedInput = false;
     bool Controller::showConsole = true;
@@ -20,13 +22,163 @@ namespace Mixijo {
     Pointer<Frame> Controller::window{};
     Controller::Theme Controller::theme{};
     std::ofstream Controller::logOutput{};
-
-    void Controller::start() {
+    Mutex Controller::logLock{};
+    Logger Controller::logger{};
+    Executor Controller::executor{};
+    Writer Controller::writer{};
+    std::map<std::string, Scene, std::less<>> Controller::scenes{};
+    double Controller::sceneFade = 0;
+    double Controller::frameRate = 30;
+    FrameTimes Controller::frameTimes{};
+    json Controller::settings{};
+    std::filesystem::file_time_type Controller::settingsTime{};
+    std::filesystem::file_time_type Controller::settingsFailed{};
+    std::chrono::steady_clock::time_point Controller::settingsChecked{};
+    string_map<int> Controller::inputChannels{};
+    string_map<int> Controller::outputChannels{};
+    bool Controller::headless = false;
+    std::atomic<bool> Controller::running{ true };
+    Control Controller::control{ "mixijo", command };
+
+    void Controller::start(bool headless) {
+        MIXIJO_TRACE_THREAD("main");
         std::filesystem::path _logpath = "logs/";
         if (!std::filesystem::exists(_logpath))
             std::filesystem::create_directory("logs/");
         logOutput.open(std::format("logs/mixijo_{:%EY%Om%Od_%OH%OM%OS}.log", std::chrono::system_clock::now()));
+        logger.start();
+
+        Controller::headless = headless;
+        if (headless) runHeadless();
+        else runGui();
+
+        saveRouting(true);
+        processor.deinit();
+        executor.stop();
+        writer.stop();
+        logger.stop();
+    }
+
+    void Controller::startEngine() {
+        const auto _start = std::chrono::steady_clock::now();
+        if (std::optional<json> _settings = readSettings()) openDevices(_settings.value());
+        else processor.init();
+        logline("Started in ", std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - _start).count(), "ms");
+
+        executor.start();
+        writer.start();
+        processor.midiin.Callback([&](const Midijo::CC& e) { // Midi thread, buttons are reloaded on the main thread
+            if (e.Value() == 0) return;
+            if (!presses.push(e.Number())) logger.errline("Too many button presses queued, ignored cc ", e.Number());
+        });
+    }
 
+    void Controller::runHeadless() {
+        logline("Running headless, send commands to the control pipe (", control.name(), ")");
+        startEngine();
+        control.start();
+
+        SetConsoleCtrlHandler([](DWORD) -> BOOL { running = false; return TRUE; }, TRUE);
+        while (running) {
+            handleButtons();
+            watchSettings();
+            Realtime::report([](std::string_view violation) { errline(violation); });
+            Scheduling::apply(Scheduling::Main);
+            control.handle();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        control.stop();
+    }
+
+    std::string Controller::command(std::string_view line) {
+        std::vector<std::string> _args;
+        for (std::size_t i = 0; i < line.size();) {
+            if (line[i] == ' ' || line[i] == '\t') { ++i; continue; }
+            const bool _quoted = line[i] == '"';
+            const std::size_t _start = i + _quoted;
+            const std::size_t _end = _quoted ? line.find('"', _start) : line.find_first_of(" \t", _start);
+            _args.emplace_back(line.substr(_start, _end == std::string_view::npos ? line.npos : _end - _start));
+            i = _end == std::string_view::npos ? line.size() : _end + _quoted;
+        }
+
+        const auto _number = [](std::string_view value) -> std::optional<double> {
+            double _result = 0;
+            auto [_ptr, _error] = std::from_chars(value.data(), value.data() + value.size(), _result);
+            if (_error != std::errc{} || _ptr != value.data() + value.size()) return {};
+            return _result;
+        };
+
+        // Channels are only changed through access and read through read, the audio thread fades them
+        const auto _channel = [](std::string_view type, std::string_view name, bool change, auto fn) {
+            if (type != "input" && type != "output") return false;
+            const bool _input = type == "input";
+            const int _id = findChannel(name, _input);
+            if (_id == -1) return false;
+            const auto _select = [&](const Processor::Inputs& in, const Processor::Outputs& out) {
+                fn(_input ? static_cast<Channel&>(in[_id]) : static_cast<Channel&>(out[_id]));
+            };
+            if (change) processor.access(_select);
+            else processor.read(_select);
+            return true;
+        };
+
+        if (_args.empty()) return "error: empty command";
+        const std::string_view _command = _args[0];
+        if (_command == "list" && _args.size() == 1) {
+            std::string _result = "outputs:";
+            for (auto& _output : processor.outputs) _result += " \"" + _output.name + "\"";
+            _result += " inputs:";
+            for (auto& _input : processor.inputs) _result += " \"" + _input.name + "\"";
+            return _result;
+        } else if (_command == "get" && _args.size() == 3) {
+            std::ostringstream _settings;
+            if (!_channel(_args[1], _args[2], false, [&](Channel& channel) { channel.getSettings(_settings); }))
+                return "error: no " + _args[1] + " named " + _args[2];
+            return _settings.str();
+        } else if (_command == "set" && _args.size() == 5) {
+            if (_args[3] != "gain" && _args[3] != "limiter") return "error: unknown setting " + _args[3];
+            const auto _value = _number(_args[4]);
+            if (!_value) return "error: invalid value " + _args[4];
+            if (!_channel(_args[1], _args[2], true, [&](Channel& channel) { channel.setSetting(_args[3], _value.value()); }))
+                return "error: no " + _args[1] + " named " + _args[2];
+            saveRouting();
+            return "ok";
+        } else if (_command == "route" && _args.size() == 4) {
+            const int _input = findChannel(_args[1], true);
+            const int _output = findChannel(_args[2], false);
+            const auto _value = _number(_args[3]);
+            if (_input == -1) return "error: no input named " + _args[1];
+            if (_output == -1) return "error: no output named " + _args[2];
+            if (!_value) return "error: invalid value " + _args[3];
+            processor.access([&](Processor::Inputs& in, Processor::Outputs&) {
+                in[_input].output_levels[_output] = _value.value() != 0;
+            });
+            saveRouting();
+            return "ok";
+        } else if (_command == "scene" && (_args.size() == 2 || _args.size() == 3)) {
+            if (!scenes.contains(_args[1])) return "error: no scene named " + _args[1];
+            const auto _fade = _args.size() == 3 ? _number(_args[2]) : -1.;
+            if (!_fade) return "error: invalid fade " + _args[2];
+            recallScene(_args[1], _fade.value());
+            return "ok";
+        } else if (_command == "savescene" && _args.size() == 2) {
+            if (!saveScene(_args[1])) return "error: invalid scene name " + _args[1];
+            return "ok";
+        } else if (_command == "reload" && _args.size() == 1) {
+            reloadSettings();
+            return "ok";
+        } else if (_command == "trace" && _args.size() == 1) {
+            dumpTrace();
+            return "ok";
+        } else if (_command == "quit" && _args.size() == 1) {
+            running = false;
+            return "ok";
+        }
+        return "error: unknown command, expected one of list, get, set, route, scene, savescene, reload, trace, quit";
+    }
+
+    void Controller::runGui() {
         Guijo::Gui _gui;
         window = _gui.emplace<Frame>(Window::Construct{
             .name = "Mixijo",
@@ -38,22 +190,28 @@ namespace Mixijo {
         window->event<[](Window& self, const KeyPress& e) {
             if (e.keycode == 'S' && e.mod & Mods::Control) {
                 logline("Saving routing...");
-                saveRouting();
+                saveRouting(true);
                 logline("Saved routing");
             } else if (e.keycode == 'R' && e.mod & Mods::Control && e.mod & Mods::Shift) {
                 logline("Reloading settings and reopening devices...");
-                saveRouting();
-                refreshSettings();
-                processor.init();
-                refreshSettings();
-                loadRouting();
+                saveRouting(true);
+                processor.rescan();
+                if (std::optional<json> _settings = readSettings()) openDevices(_settings.value());
+                else processor.init();
                 logline("Reloaded settings and reopened devices");
             } else if (e.keycode == 'R' && e.mod & Mods::Control) {
                 logline("Reloading settings...");
-                saveRouting();
-                refreshSettings();
-                loadRouting();
-                logline("Reloaded settings");
+                reloadSettings();
+            } else if (e.keycode >= '1' && e.keycode <= '9' && e.mod & Mods::Control && e.mod & Mods::Shift) {
+                saveScene(std::string(1, static_cast<char>(e.keycode)));
+            } else if (e.keycode >= '1' && e.keycode <= '9' && e.mod & Mods::Control) {
+                recallScene(std::string(1, static_cast<char>(e.keycode)));
+            } else if (e.keycode == 'A' && e.mod & Mods::Control) {
+                if (selectedChannel == -1) return;
+                if (processor.analyzer.opened(selectedInput, selectedChannel)) processor.analyzer.close();
+                else processor.analyzer.open(selectedInput, selectedChannel, sampleRate);
+            } else if (e.keycode == 'D' && e.mod & Mods::Control) {
+                dumpTrace();
             } else if (e.keycode == 'C' && e.mod & Mods::Control) {
                 if (Controller::showConsole) {
                     Controller::showConsole = false;
@@ -102,350 +260,733 @@ namespace Mixijo {
 
                 logline("buffersize: ", Controller::bufferSize);
                 logline("sampleRate: ", Controller::sampleRate);
+                if (frameTimes.frames != 0) {
+                    // With the amount of strips, so frame times of different builds are compared on the same settings
+                    auto& _strips = window->mixer->objects();
+                    std::size_t _shown = 0;
+                    for (auto& _obj : _strips) _shown += _obj.as<Gui::Channel>()->visible;
+                    logline(std::format("gui frames: {}, {} strips ({} shown), average {:.2f}ms, longest {:.2f}ms",
+                        frameTimes.frames, _strips.size(), _shown, frameTimes.total / frameTimes.frames, frameTimes.longest));
+                    frameTimes = {};
+                }
                 if (!buttons.empty()) {
                     logline("Buttons: ");
                     for (auto& _button : buttons)
-                        logline("  ", _button.first, " -> ", _button.second);
+                        logline("  ", _button.cc, " -> ", _button.command);
                 }
                 logline("===========================================");
             }
         }>();
 
-        refreshSettings();
-        processor.init();
-        refreshSettings();
-        loadRouting();
+        startEngine();
+        // Buttons, settings and window messages are handled every millisecond, but the gui only
+        // redraws at the frame rate, and barely at all when minimized, so it doesn't take time away from the audio
+        auto _nextFrame = std::chrono::steady_clock::now();
+        bool _minimized = false;
+        while (true) {
+            handleButtons();
+            watchSettings();
+            Realtime::report([](std::string_view violation) { errline(violation); });
+            Scheduling::apply(Scheduling::Main);
+
+            const bool _open = handleEvents();
+            const auto _now = std::chrono::steady_clock::now();
+            const bool _restored = _minimized && !window->minimized(); // Don't show a stale frame for up to 250 ms
+            if (_open && _now < _nextFrame && !_restored) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
 
-        processor.midiin.Callback([&](const Midijo::CC& e) {
-            if (e.Value() == 0) return;
-            for (auto& _link : buttons) {
-                if (_link.first == e.Number()) {
-                    logline("Attempted to run file (", _link.second, ")");
-                    std::string _command = "start " + _link.second;
-                    std::system(_command.c_str());
-                }
+            {
+                MIXIJO_TRACE("Gui::loop");
+                if (!_gui.loop()) break;
             }
-            });
+            frameTimes.add(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - _now).count());
+            _minimized = window->minimized();
+            const double _fps = _minimized ? 4 : frameRate;
+            _nextFrame = _now + std::chrono::microseconds(static_cast<long long>(1e6 / _fps));
+        }
+    }
 
-        while (_gui.loop()) {
-            processor.midiin.HandleEvents();
+    bool Controller::handleEvents() {
+        MSG _message;
+        while (PeekMessage(&_message, nullptr, 0, 0, PM_REMOVE)) {
+            if (_message.message == WM_QUIT) {
+                PostQuitMessage(static_cast<int>(_message.wParam)); // Left for the gui loop, which ends on it
+                return false;
+            }
+            TranslateMessage(&_message);
+            DispatchMessage(&_message);
         }
+        return true;
+    }
 
-        saveRouting();
-        processor.deinit();
+    void Controller::handleButtons() {
+        for (int _cc; presses.pop(_cc);)
+            for (auto& _button : buttons)
+                if (_button.cc == _cc) run(_button);
     }
 
-    void Controller::refreshSettings() {
-        std::ifstream _file{ "./settings.json" };
-        if (!_file.is_open()) {
-            errline("cannot find settings file!");
+    void Controller::run(Button& button) {
+        const auto _now = std::chrono::steady_clock::now();
+        if (_now - button.pressed < button.debounce) return;
+        button.pressed = _now;
+        if (!button.scene.empty()) return recallScene(button.scene, button.fade);
+        if (button.running->exchange(true)) {
+            logline("Still starting (", button.command, "), ignored button press");
             return;
         }
-        std::string _content{ std::istreambuf_iterator<char>{ _file }, std::istreambuf_iterator<char>{} };
 
-        std::optional<json> _result = json::parse(_content);
+        // Started like the start builtin did, the worker returns right away and a wait callback logs the exit code
+        auto _job = [_command = button.command, _running = button.running] {
+            struct Launched {
+                std::string command;
+                std::chrono::steady_clock::time_point start;
+                HANDLE process;
+                HANDLE wait = nullptr;
+                std::atomic<int> owners{ 2 }; // The worker and the wait callback, the last one cleans up
+
+                void release() {
+                    if (--owners != 0) return;
+                    UnregisterWait(wait); // Doesn't wait for the callback, so it may be called from it
+                    CloseHandle(process);
+                    delete this;
+                }
+            };
+
+            std::string _line = "cmd /s /c \"" + _command + "\"";
+            STARTUPINFOA _startup{ .cb = sizeof(STARTUPINFOA) };
+            PROCESS_INFORMATION _process{};
+            const auto _start = std::chrono::steady_clock::now();
+            const bool _created = CreateProcessA(nullptr, _line.data(), nullptr, nullptr, FALSE, CREATE_NO_WINDOW, nullptr, nullptr, &_startup, &_process);
+            *_running = false;
+            if (!_created) {
+                errline("Failed to run file (", _command, "), error ", GetLastError());
+                return;
+            }
+            CloseHandle(_process.hThread);
+
+            auto _launched = new Launched{ _command, _start, _process.hProcess };
+            const auto _exited = [](void* context, BOOLEAN) {
+                auto _launched = static_cast<Launched*>(context);
+                DWORD _result = 0;
+                const bool _known = GetExitCodeProcess(_launched->process, &_result);
+                const auto _duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - _launched->start);
+                if (_known && _result == 0) logline("Ran file (", _launched->command, ") in ", _duration.count(), "ms");
+                else if (_known) errline("Failed to run file (", _launched->command, "), exit code ", _result, " after ", _duration.count(), "ms");
+                _launched->release();
+            };
+
+            HANDLE _wait = nullptr;
+            if (!RegisterWaitForSingleObject(&_wait, _launched->process, _exited, _launched, INFINITE, WT_EXECUTEONLYONCE)) {
+                logline("Started file (", _command, "), its exit code won't be logged");
+                CloseHandle(_launched->process);
+                delete _launched;
+                return;
+            }
+            _launched->wait = _wait;
+            _launched->release();
+        };
+
+        if (!executor.submit(std::move(_job))) {
+            *button.running = false;
+            errline("Too many commands queued, ignored (", button.command, ")");
+        }
+    }
+
+    std::optional<json> Controller::readSettings() {
+        // Time from before reading, so a write while reading is seen as a change. Only recorded
+        // when the file parses, a file that's still being written is read again by watchSettings.
+        std::error_code _error;
+        const auto _time = std::filesystem::last_write_time("./settings.json", _error);
+        const bool _reported = !_error && _time == settingsFailed; // Only report each failed version once
+
+        std::optional<std::string> _content = readFile("./settings.json");
+        if (!_content.has_value()) {
+            if (!_reported) errline("cannot find settings file!");
+            if (!_error) settingsFailed = _time;
+            return {};
+        }
+
+        std::optional<json> _result = json::parse(_content.value());
         if (!_result.has_value()) {
-            errline("cannot parse settings file! Invalid json.");
-            return;
+            if (!_reported) errline("cannot parse settings file! Invalid json.");
+            if (!_error) settingsFailed = _time;
+            return {};
         }
 
+        if (!_error) settingsTime = _time;
+        return _result;
+    }
+
+    void Controller::openDevices(json& config) {
+        MIXIJO_TRACE("Controller::openDevices");
+        const auto _start = std::chrono::steady_clock::now();
+        applyGeneral(config);
+        processor.init();
+
+        const auto _opened = std::chrono::steady_clock::now();
+        applyButtons(config);
+        applyChannels(config);
+        applyTheme(config);
+        loadRouting();
+        settings = std::move(config);
+
+        const auto _ms = [](auto duration) { return std::chrono::duration_cast<std::chrono::milliseconds>(duration).count(); };
+        logline("Opened devices in ", _ms(_opened - _start), "ms, built channels in ", _ms(std::chrono::steady_clock::now() - _opened), "ms");
+    }
+
+    void Controller::reloadSettings() {
+        MIXIJO_TRACE("Controller::reloadSettings");
+        std::optional<json> _result = readSettings();
+        if (!_result.has_value()) return;
+
         json& _json = _result.value();
+        const auto _changed = [&](std::string_view key) {
+            if (settings.contains(key) != _json.contains(key)) return true;
+            return _json.contains(key) && !(settings[key] == _json[key]);
+        };
+
+        // Only reopen the audio device when its settings changed, this causes a dropout
+        if (_changed("audio") || _changed("samplerate") || _changed("buffersize")) {
+            logline("Audio device settings changed, reopening devices...");
+            saveRouting(true);
+            processor.rescan();
+            openDevices(_json);
+            logline("Reloaded settings and reopened devices");
+            return;
+        }
 
-        if (_json.contains("audio", json::String)) audioDevice = _json["audio"].as<json::string>();
-        if (_json.contains("samplerate", json::Unsigned)) sampleRate = _json["samplerate"].as<json::unsigned_integral>();
-        if (_json.contains("buffersize", json::Unsigned)) bufferSize = _json["buffersize"].as<json::unsigned_integral>();
-        if (_json.contains("midiin", json::String)) midiinDevice = _json["midiin"].as<json::string>();
-        if (_json.contains("midiout", json::String)) midioutDevice = _json["midiout"].as<json::string>();
-        if (_json.contains("buttons", json::Array)) {
-            buttons.clear();
-            for (auto& _link : _json["buttons"].as<json::array>()) {
-                if (_link.contains("cc", json::Unsigned) && _link.contains("run", json::String)) {
-                    buttons.push_back({
-                        (int)_link["cc"].as<json::unsigned_integral>(),
-                        _link["run"].as<json::string>() 
-                    });
-                }
+        applyGeneral(_json);
+        if (_changed("midiin") || _changed("midiout")) {
+            logline("Midi device settings changed, reopening midi devices...");
+            processor.reopenMidi();
+        }
+        if (_changed("buttons")) applyButtons(_json);
+        if (_changed("channels")) updateChannels(_json);
+        if (_changed("theme")) applyTheme(_json);
+        settings = std::move(_json);
+        logline("Reloaded settings");
+    }
+
+    void Controller::watchSettings() {
+        const auto _now = std::chrono::steady_clock::now();
+        if (_now - settingsChecked < std::chrono::milliseconds(250)) return;
+        settingsChecked = _now;
+
+        std::error_code _error;
+        const auto _time = std::filesystem::last_write_time("./settings.json", _error);
+        if (_error || _time == settingsTime) return;
+        if (_time != settingsFailed) logline("Settings file changed, reloading...");
+        reloadSettings();
+    }
+
+    void Controller::applyGeneral(json& config) {
+        if (config.contains("audio", json::String)) audioDevice = config["audio"].as<json::string>();
+        if (config.contains("samplerate", json::Unsigned)) sampleRate = config["samplerate"].as<json::unsigned_integral>();
+        if (config.contains("buffersize", json::Unsigned)) bufferSize = config["buffersize"].as<json::unsigned_integral>();
+        if (config.contains("midiin", json::String)) midiinDevice = config["midiin"].as<json::string>();
+        if (config.contains("midiout", json::String)) midioutDevice = config["midiout"].as<json::string>();
+        if (config.contains("framerate", json::Unsigned)) frameRate = std::max<json::unsigned_integral>(config["framerate"].as<json::unsigned_integral>(), 1);
+        if (config.contains("scenefade", json::Unsigned)) sceneFade = config["scenefade"].as<json::unsigned_integral>();
+        if (config.contains("feedbackrate", json::Unsigned)) processor.feedback.rate = config["feedbackrate"].as<json::unsigned_integral>();
+
+        Scheduling::Settings _scheduling{};
+        if (config.contains("realtime", json::Boolean)) _scheduling.realtime = config["realtime"].as<json::boolean>();
+        if (config.contains("lockmemory", json::Boolean)) _scheduling.lockMemory = config["lockmemory"].as<json::boolean>();
+        if (config.contains("affinity", json::Object)) {
+            auto& _affinity = config["affinity"];
+            for (std::size_t i = 0; i < Scheduling::Threads; ++i) {
+                if (!_affinity.contains(Scheduling::Names[i], json::Array)) continue;
+                for (auto& _cpu : _affinity[Scheduling::Names[i]].as<json::array>())
+                    if (_cpu.is(json::Unsigned) && _cpu.as<json::unsigned_integral>() < 64)
+                        _scheduling.affinity[i] |= std::uint64_t{ 1 } << _cpu.as<json::unsigned_integral>();
             }
         }
-        if (_json.contains("channels", json::Object)) {
-            auto _mixer = window->mixer.as<Gui::Mixer>();
-            _mixer->objects().clear();
-            processor.access([](Processor::Inputs& in, Processor::Outputs& out) {
-                in.clear();
-                out.clear();
-            });
 
-            auto _addChannel = [&](json& channel, bool input) {
-                processor.access([&](Processor::Inputs& in, Processor::Outputs& out) {
-                    auto& _channel = input ? (Channel&) in.add() : out.add();
-
-                    if (channel.contains("endpoints")) {
-                        if (channel["endpoints"].is(json::Array)) {
-                            auto& _endpoints = channel["endpoints"].as<json::array>();
-                            for (auto& _endpoint : _endpoints) if (_endpoint.is(json::String)) {
-                                int _id = processor.find_endpoint(_endpoint.as<json::string>(), input);
-                                if (_id != -1) _channel.add(_id);
-                                else errline("could not find endpoint \"", _endpoint.as<json::string>(), "\"");
-                            } else errline("endpoint should be a string.");
-                        } else errline("endpoints should be an array of strings.");
-                    }
+        // This covers the queues and the rest of the processor, its arena is locked separately
+        const bool _locked = Scheduling::lockMemory();
+        Scheduling::configure(_scheduling);
+        if (_scheduling.lockMemory && !_locked) {
+            Scheduling::lock(&processor, sizeof(Processor));
+            processor.lockArena(true);
+        } else if (!_scheduling.lockMemory && _locked) {
+            Scheduling::unlock(&processor, sizeof(Processor));
+            processor.lockArena(false);
+        }
+    }
 
-                    if (channel.contains("midimapping")) {
-                        if (channel["midimapping"].is(json::Array)) {
-                            for (auto& _map : channel["midimapping"].as<json::array>()) {
-                                if (_map.contains("cc", json::Unsigned) && _map.contains("param", json::String)) {
-                                    _channel.addMidiLink(_map["param"].as<json::string>(), _map["cc"].as<json::unsigned_integral>());
-                                } else {
-                                    errline("failed to parse a midi mapping, should be a json object like this:");
-                                    errline("  { \"cc\": 73, \"param\" : \"gain\" }");
-                                }
-                            }
-                        } else errline("midimapping should be an array of json objects.");
-                    }
+    void Controller::applyButtons(json& config) {
+        buttons.clear();
+        if (!config.contains("buttons", json::Array)) return;
+        for (auto& _link : config["buttons"].as<json::array>()) {
+            if (_link.contains("cc", json::Unsigned) && (_link.contains("run", json::String) || _link.contains("scene", json::String))) {
+                auto& _button = buttons.emplace_back((int)_link["cc"].as<json::unsigned_integral>());
+                if (_link.contains("run", json::String)) _button.command = _link["run"].as<json::string>();
+                if (_link.contains("scene", json::String)) _button.scene = _link["scene"].as<json::string>();
+                if (_link.contains("fade", json::Unsigned)) _button.fade = _link["fade"].as<json::unsigned_integral>();
+                if (_link.contains("debounce", json::Unsigned))
+                    _button.debounce = std::chrono::milliseconds(_link["debounce"].as<json::unsigned_integral>());
+            }
+        }
+    }
 
-                    int _size = input ? in.size() : out.size();
-                    if (channel.contains("name", json::String))
-                        _mixer->emplace<Gui::Channel>(_size - 1, input, channel["name"].as<json::string>());
-                    else _mixer->emplace<Gui::Channel>(_size - 1, input, "channel");
-                });
+    void Controller::applyChannels(json& config) {
+        if (!config.contains("channels", json::Object)) return;
+        processor.analyzer.close(); // The analyzed channel might not exist anymore
+        if (!headless) {
+            window->mixer->objects().clear();
+            window->mixer.as<Gui::Mixer>()->invalidate();
+        }
+        // Build all channels at once, so they're handed to the audio thread in one graph
+        processor.access([&](Processor::Inputs& in, Processor::Outputs& out) {
+            in.clear();
+            out.clear();
+            processor.clearMidiLinks();
+
+            auto _addChannel = [&](json& channel, bool input) {
+                auto& _channel = input ? (Channel&) in.add() : out.add();
+                int _size = input ? in.size() : out.size();
+                applyEndpoints(channel, input, _channel);
+                applyMidiMappings(channel, input, _size - 1);
+                if (channel.contains("name", json::String)) _channel.name = channel["name"].as<json::string>();
             };
 
-            auto& _channels = _json["channels"];
+            auto& _channels = config["channels"];
             if (_channels.contains("outputs", json::Array))
                 for (auto& _channel : _channels["outputs"].as<json::array>())
                     _addChannel(_channel, false);
             if (_channels.contains("inputs", json::Array))
                 for (auto& _channel : _channels["inputs"].as<json::array>())
                     _addChannel(_channel, true);
+        });
+
+        if (!headless) { // Strips only refer to their channel by index, so they're added after the handoff
+            auto _mixer = window->mixer.as<Gui::Mixer>();
+            for (std::size_t i = 0; i < processor.outputs.size(); ++i) _mixer->emplace<Gui::Channel>(static_cast<int>(i), false);
+            for (std::size_t i = 0; i < processor.inputs.size(); ++i) _mixer->emplace<Gui::Channel>(static_cast<int>(i), true);
         }
-        if (_json.contains("theme", json::Object)) {
-            theme.reset();
-            auto& _theme = _json["theme"];
-            logline("loading theme...");
-            constexpr auto _decodeColor = [](json& j, auto name) -> Color {
-                if (!j.is(json::Array)) {
-                    errline("failed to parse \"", name, "\", expecting json array.");
-                    return Color{};
-                }
-                for (auto& v : j.as<json::array>()) if (!v.is(json::Unsigned)) {
-                    errline("failed to parse \"", name, "\", expecting json array with 1 to 4 unsigned integrals.");
-                    return Color{};
-                }
-                if (j.size() == 1) return Color{
-                    static_cast<float>(j[0].as<json::unsigned_integral>()) };
-                if (j.size() == 2) return Color{
-                    static_cast<float>(j[0].as<json::unsigned_integral>()),
-                    static_cast<float>(j[1].as<json::unsigned_integral>()) };
-                if (j.size() == 3) return Color{
-                    static_cast<float>(j[0].as<json::unsigned_integral>()),
-                    static_cast<float>(j[1].as<json::unsigned_integral>()),
-                    static_cast<float>(j[2].as<json::unsigned_integral>()) };
-                if (j.size() == 4) return Color{
-                    static_cast<float>(j[0].as<json::unsigned_integral>()),
-                    static_cast<float>(j[1].as<json::unsigned_integral>()),
-                    static_cast<float>(j[2].as<json::unsigned_integral>()),
-                    static_cast<float>(j[3].as<json::unsigned_integral>()) }; 
-                errline("failed to parse \"", name, "\", expecting json array with 1 to 4 unsigned integrals.");
-                return Color{};
-            };
 
-            constexpr auto _giveColor = [](auto& t, json& j, auto name) {
-                if (j.is(json::Array)) t.value.emplace(_decodeColor(j, std::string{ name } + ".color"));
-                else if (j.is(json::Object)) {
-                    if (j.contains("transition")) if (j["transition"].is(json::Unsigned)) {
-                        t.transition = j["transition"].as<json::unsigned_integral>();
-                    } else errline("failed to parse \"", name, ".transition\", expecting unsigned integral.");
-                    if (j.contains("color")) if (j["color"].is(json::Array)) {
-                        t.value.emplace(_decodeColor(j["color"], std::string{ name } + ".color"));
-                    } else errline("failed to parse \"", name, ".color\", expecting json array.");
-                    for (auto& [_key, _value] : j.as<json::object>()) {
-                        if (_key == "disabled") t.statelinked.push_back({ Disabled, _decodeColor(j["disabled"], std::string{ name } + ".disabled") });
-                        if (_key == "hovering") t.statelinked.push_back({ Hovering, _decodeColor(j["hovering"], std::string{ name } + ".hovering") });
-                        if (_key == "selected") t.statelinked.push_back({ Selected, _decodeColor(j["selected"], std::string{ name } + ".selected") });
-                        if (_key == "pressed") t.statelinked.push_back({ Pressed, _decodeColor(j["pressed"], std::string{ name } + ".pressed") });
-                        if (_key == "focused") t.statelinked.push_back({ Focused, _decodeColor(j["focused"], std::string{ name } + ".focused") });
-                    }
-                } else errline("failed to parse Color \"", name, "\", expecting json array or object");
-            };
-            
-            constexpr auto _giveValue = [](auto& t, json& j, auto name) {
-                if (j.is(json::Unsigned)) t.value.emplace(j.as<json::unsigned_integral>());
-                else if (j.is(json::Object)) {
-                    if (j.contains("transition")) if (j["transition"].is(json::Unsigned)) {
-                        t.transition = j["transition"].as<json::unsigned_integral>();
-                    } else errline("failed to parse \"", name, ".transition\", expecting unsigned integral.");
-                    if (j.contains("value")) if (j["value"].is(json::Unsigned)) {
-                        t.value.emplace(j["value"].as<json::unsigned_integral>());
-                    } else errline("failed to parse \"", name, ".value\", expecting unsigned integral.");
-                    for (auto& [_key, _value] : j.as<json::object>()) {
-                        if (_key == "disabled") if (_value.type() == json::Unsigned)
-                            t.statelinked.push_back({ Disabled, j["disabled"].as<json::unsigned_integral>() });
-                        else errline("failed to parse \"", name, ".disabled\", expecting unsigned integral.");
-                        if (_key == "hovering") if (_value.type() == json::Unsigned)
-                            t.statelinked.push_back({ Hovering, j["hovering"].as<json::unsigned_integral>() });
-                        else errline("failed to parse \"", name, ".hovering\", expecting unsigned integral.");
-                        if (_key == "selected") if (_value.type() == json::Unsigned)
-                            t.statelinked.push_back({ Selected, j["selected"].as<json::unsigned_integral>() });
-                        else errline("failed to parse \"", name, ".selected\", expecting unsigned integral.");
-                        if (_key == "pressed") if (_value.type() == json::Unsigned)
-                            t.statelinked.push_back({ Pressed, j["pressed"].as<json::unsigned_integral>() });
-                        else errline("failed to parse \"", name, ".pressed\", expecting unsigned integral.");
-                        if (_key == "focused") if (_value.type() == json::Unsigned)
-                            t.statelinked.push_back({ Focused, j["focused"].as<json::unsigned_integral>() });
-                        else errline("failed to parse \"", name, ".focused\", expecting unsigned integral.");
-                    }
-                } else errline("failed to parse number \"", name, "\", expecting unsigned integer or object");
-            };
+        indexChannels();
+        loadScenes();
+    }
 
-            if (_theme.contains("background")) _giveColor(theme.background, _theme["background"], "theme.background");
-            if (_theme.contains("divider")) _giveColor(theme.divider, _theme["divider"], "theme.divider");
-            if (_theme.contains("border")) _giveColor(theme.border, _theme["border"], "theme.border");
-            if (_theme.contains("channel")) {
-                auto& _channel = _theme["channel"];
-                if (_channel.contains("background")) _giveColor(theme.channel.background, _channel["background"], "theme.channel.background");
-                if (_channel.contains("slider")) _giveColor(theme.channel.slider, _channel["slider"], "theme.channel.slider");
-                if (_channel.contains("meter")) {
-                    auto& _meter = _channel["meter"];
-                    _giveColor(theme.channel.meter, _meter, "meter");
-                    if (_meter.contains("text")) _giveColor(theme.channel.meterText, _meter["text"], "theme.channel.meter.text");
-                    if (_meter.contains("line1")) _giveColor(theme.channel.meterLine1, _meter["line1"], "theme.channel.meter.line1");
-                    if (_meter.contains("line2")) _giveColor(theme.channel.meterLine2, _meter["line2"], "theme.channel.meter.line2");
-                    if (_meter.contains("background")) _giveColor(theme.channel.meterBackground, _meter["background"], "theme.channel.meter.background");
-                }
-                if (_channel.contains("border")) {
-                    auto& _border = _channel["border"];
-                    _giveColor(theme.channel.border, _border, "theme.channel.border");
-                    if (_border.contains("width")) _giveValue(theme.channel.borderWidth, _border["width"], "theme.channel.border.width");
-                }
-                if (_channel.contains("title")) _giveColor(theme.channel.title, _channel["title"], "theme.channel.title");
-                if (_channel.contains("value")) _giveColor(theme.channel.value, _channel["value"], "theme.channel.value");
+    void Controller::updateChannels(json& config) {
+        auto& _from = settings["channels"];
+        auto& _to = config["channels"];
+        const auto _count = [](json& channels, std::string_view key) -> std::size_t {
+            return channels.contains(key, json::Array) ? channels[key].as<json::array>().size() : 0;
+        };
+
+        // Channels are matched by position, so when channels are added or removed everything is rebuilt
+        if (!_from.is(json::Object) || !_to.is(json::Object)
+            || _count(_from, "outputs") != _count(_to, "outputs")
+            || _count(_from, "inputs") != _count(_to, "inputs")) {
+            logline("Channels were added or removed, rebuilding channels...");
+            saveRouting(true);
+            applyChannels(config);
+            loadRouting();
+            return;
+        }
+
+        bool _midiChanged = false;
+        bool _namesChanged = false;
+        const auto _update = [&](std::string_view key, bool input) {
+            if (!_to.contains(key, json::Array)) return;
+            auto& _old = _from[key].as<json::array>();
+            auto& _new = _to[key].as<json::array>();
+            for (std::size_t i = 0; i < _new.size(); ++i) {
+                if (_old[i] == _new[i]) continue;
+                const auto _differs = [&](std::string_view name) {
+                    if (_old[i].contains(name) != _new[i].contains(name)) return true;
+                    return _new[i].contains(name) && !(_old[i][name] == _new[i][name]);
+                };
+
+                if (_differs("endpoints")) processor.access([&](Processor::Inputs& in, Processor::Outputs& out) {
+                    auto& _channel = input ? (Channel&) in[i] : out[i];
+                    _channel.clearEndpoints();
+                    applyEndpoints(_new[i], input, _channel);
+                });
+
+                if (_differs("midimapping")) _midiChanged = true;
+
+                if (_differs("name")) processor.access([&](Processor::Inputs& in, Processor::Outputs& out) {
+                    auto& _channel = input ? (Channel&) in[i] : out[i];
+                    _channel.name = _new[i].contains("name", json::String) ? _new[i]["name"].as<json::string>() : "channel";
+                    _namesChanged = true;
+                });
+                logline("Updated ", input ? "input" : "output", " channel ", i);
             }
-            if (_theme.contains("routebutton")) {
-                auto& _rbttn = _theme["routebutton"];
-                if (_rbttn.contains("background")) _giveColor(theme.routebutton.background, _rbttn["background"], "theme.routebutton.background");
-                if (_rbttn.contains("border")) {
-                    auto& _border = _rbttn["border"];
-                    _giveColor(theme.routebutton.border, _border, "theme.routebutton.border");
-                    if (_border.contains("width")) _giveValue(theme.routebutton.borderWidth, _border["width"], "theme.routebutton.border.width");
+        };
+
+        _update("outputs", false);
+        _update("inputs", true);
+
+        // Midi mappings are stored per mapping, not per channel, so rebuild them all
+        if (_midiChanged) processor.access([&](Processor::Inputs&, Processor::Outputs&) {
+            processor.clearMidiLinks();
+            if (_to.contains("outputs", json::Array))
+                for (int i = 0; auto& _channel : _to["outputs"].as<json::array>())
+                    applyMidiMappings(_channel, false, i++);
+            if (_to.contains("inputs", json::Array))
+                for (int i = 0; auto& _channel : _to["inputs"].as<json::array>())
+                    applyMidiMappings(_channel, true, i++);
+        });
+
+        if (_namesChanged) {
+            indexChannels();
+            loadScenes(); // Scenes are matched by channel names
+        }
+    }
+
+    void Controller::applyEndpoints(json& channel, bool input, Channel& result) {
+        if (!channel.contains("endpoints")) return;
+        if (!channel["endpoints"].is(json::Array)) return errline("endpoints should be an array of strings.");
+        for (auto& _endpoint : channel["endpoints"].as<json::array>()) if (_endpoint.is(json::String)) {
+            int _id = processor.find_endpoint(_endpoint.as<json::string>(), input);
+            if (_id != -1) result.add(_id);
+            else errline("could not find endpoint \"", _endpoint.as<json::string>(), "\"");
+        } else errline("endpoint should be a string.");
+    }
+
+    void Controller::applyMidiMappings(json& channel, bool input, int index) {
+        if (!channel.contains("midimapping")) return;
+        if (!channel["midimapping"].is(json::Array)) return errline("midimapping should be an array of json objects.");
+        for (auto& _map : channel["midimapping"].as<json::array>()) {
+            std::optional<Processor::MidiSource> _source{};
+            if (_map.contains("cc", json::Unsigned)) {
+                _source = { Processor::MidiSource::CC, (int)_map["cc"].as<json::unsigned_integral>() };
+                if (_map.contains("lsb", json::Unsigned)) {
+                    _source->type = Processor::MidiSource::CC14;
+                    _source->lsb = (int)_map["lsb"].as<json::unsigned_integral>();
                 }
+            } else if (_map.contains("nrpn", json::Unsigned)) {
+                _source = { Processor::MidiSource::NRPN, (int)_map["nrpn"].as<json::unsigned_integral>() };
+            } else if (_map.contains("pitchbend", json::Unsigned)) {
+                _source = { Processor::MidiSource::PitchBend, (int)_map["pitchbend"].as<json::unsigned_integral>() };
             }
-            if (_theme.contains("close")) {
-                auto& _close = _theme["close"];
-                if (_close.contains("background")) _giveColor(theme.close.background, _close["background"], "theme.close.background");
-                if (_close.contains("icon")) _giveColor(theme.close.icon, _close["icon"], "theme.close.icon");
-            }
-            if (_theme.contains("minimize")) {
-                auto& _minimize = _theme["minimize"];
-                if (_minimize.contains("background")) _giveColor(theme.minimize.background, _minimize["background"], "theme.minimize.background");
-                if (_minimize.contains("icon")) _giveColor(theme.minimize.icon, _minimize["icon"], "theme.minimize.icon");
-            }
-            if (_theme.contains("maximize")) {
-                auto& _maximize = _theme["maximize"];
-                if (_maximize.contains("background")) _giveColor(theme.maximize.background, _maximize["background"], "theme.maximize.background");
-                if (_maximize.contains("icon")) _giveColor(theme.maximize.icon, _maximize["icon"], "theme.maximize.icon");
+
+            if (_source && _map.contains("param", json::String)) {
+                const bool _feedback = _map.contains("feedback", json::Boolean) && _map["feedback"].as<json::boolean>();
+                processor.addMidiLink(input, index, _map["param"].as<json::string>(), _source.value(), _feedback);
+            } else {
+                errline("failed to parse a midi mapping, should be a json object like one of these:");
+                errline("  { \"cc\": 73, \"param\" : \"gain\" }");
+                errline("  { \"cc\": 7, \"lsb\": 39, \"param\" : \"gain\" }");
+                errline("  { \"nrpn\": 1024, \"param\" : \"gain\" }");
+                errline("  { \"pitchbend\": 1, \"param\" : \"gain\" }");
             }
-            logline("loaded theme");
-            window->updateTheme(); // Update theme in gui
         }
     }
 
-    void Controller::loadRouting() {
-        auto _mixer = window->mixer.as<Gui::Mixer>();
+    void Controller::applyTheme(json& config) {
+        theme.reset();
+        if (!config.contains("theme", json::Object)) {
+            if (!headless) window->updateTheme();
+            return;
+        }
+        auto& _theme = config["theme"];
+        logline("loading theme...");
+        constexpr auto _decodeColor = [](json& j, auto name) -> Color {
+            if (!j.is(json::Array)) {
+                errline("failed to parse \"", name, "\", expecting json array.");
+                return Color{};
+            }
+            for (auto& v : j.as<json::array>()) if (!v.is(json::Unsigned)) {
+                errline("failed to parse \"", name, "\", expecting json array with 1 to 4 unsigned integrals.");
+                return Color{};
+            }
+            if (j.size() == 1) return Color{
+                static_cast<float>(j[0].as<json::unsigned_integral>()) };
+            if (j.size() == 2) return Color{
+                static_cast<float>(j[0].as<json::unsigned_integral>()),
+                static_cast<float>(j[1].as<json::unsigned_integral>()) };
+            if (j.size() == 3) return Color{
+                static_cast<float>(j[0].as<json::unsigned_integral>()),
+                static_cast<float>(j[1].as<json::unsigned_integral>()),
+                static_cast<float>(j[2].as<json::unsigned_integral>()) };
+            if (j.size() == 4) return Color{
+                static_cast<float>(j[0].as<json::unsigned_integral>()),
+                static_cast<float>(j[1].as<json::unsigned_integral>()),
+                static_cast<float>(j[2].as<json::unsigned_integral>()),
+                static_cast<float>(j[3].as<json::unsigned_integral>()) }; 
+            errline("failed to parse \"", name, "\", expecting json array with 1 to 4 unsigned integrals.");
+            return Color{};
+        };
+
+        constexpr auto _giveColor = [](auto& t, json& j, auto name) {
+            if (j.is(json::Array)) t.value.emplace(_decodeColor(j, std::string{ name } + ".color"));
+            else if (j.is(json::Object)) {
+                if (j.contains("transition")) if (j["transition"].is(json::Unsigned)) {
+                    t.transition = j["transition"].as<json::unsigned_integral>();
+                } else errline("failed to parse \"", name, ".transition\", expecting unsigned integral.");
+                if (j.contains("color")) if (j["color"].is(json::Array)) {
+                    t.value.emplace(_decodeColor(j["color"], std::string{ name } + ".color"));
+                } else errline("failed to parse \"", name, ".color\", expecting json array.");
+                for (auto& [_key, _value] : j.as<json::object>()) {
+                    if (_key == "disabled") t.statelinked.push_back({ Disabled, _decodeColor(j["disabled"], std::string{ name } + ".disabled") });
+                    if (_key == "hovering") t.statelinked.push_back({ Hovering, _decodeColor(j["hovering"], std::string{ name } + ".hovering") });
+                    if (_key == "selected") t.statelinked.push_back({ Selected, _decodeColor(j["selected"], std::string{ name } + ".selected") });
+                    if (_key == "pressed") t.statelinked.push_back({ Pressed, _decodeColor(j["pressed"], std::string{ name } + ".pressed") });
+                    if (_key == "focused") t.statelinked.push_back({ Focused, _decodeColor(j["focused"], std::string{ name } + ".focused") });
+                }
+            } else errline("failed to parse Color \"", name, "\", expecting json array or object");
+        };
         
-        for (auto& _input : Controller::processor.inputs)
-            for (auto& _output : _input.output_levels)
-                _output = 0;
-
-        std::ifstream _file{ "./routing.txt" };
-        if (!_file.is_open()) return;
-        for (std::string _str; std::getline(_file, _str);) {
-            std::string_view _view = _str;
-            if (!_view.contains(":") || _view.starts_with("#")) continue;
-            auto _parts = split(_view, ':');
-            if (_parts.size() < 2) continue;
-            auto _isInput = _parts.size() == 3;
-            auto _channelName = trim(_parts[0]);                     // part 1: input
-            auto _settings = trim(_parts[1], " \t\n\r\f\v[]"); // part 2: channel settings
-
-            int _channelId = -1;
-            for (auto& _obj : _mixer->objects()) {
-                auto _channel = _obj.as<Gui::Channel>();
-                if (_channel->input == _isInput && _channelName == _channel->name) {
-                    _channelId = _channel->id;
-                    break;
+        constexpr auto _giveValue = [](auto& t, json& j, auto name) {
+            if (j.is(json::Unsigned)) t.value.emplace(j.as<json::unsigned_integral>());
+            else if (j.is(json::Object)) {
+                if (j.contains("transition")) if (j["transition"].is(json::Unsigned)) {
+                    t.transition = j["transition"].as<json::unsigned_integral>();
+                } else errline("failed to parse \"", name, ".transition\", expecting unsigned integral.");
+                if (j.contains("value")) if (j["value"].is(json::Unsigned)) {
+                    t.value.emplace(j["value"].as<json::unsigned_integral>());
+                } else errline("failed to parse \"", name, ".value\", expecting unsigned integral.");
+                for (auto& [_key, _value] : j.as<json::object>()) {
+                    if (_key == "disabled") if (_value.type() == json::Unsigned)
+                        t.statelinked.push_back({ Disabled, j["disabled"].as<json::unsigned_integral>() });
+                    else errline("failed to parse \"", name, ".disabled\", expecting unsigned integral.");
+                    if (_key == "hovering") if (_value.type() == json::Unsigned)
+                        t.statelinked.push_back({ Hovering, j["hovering"].as<json::unsigned_integral>() });
+                    else errline("failed to parse \"", name, ".hovering\", expecting unsigned integral.");
+                    if (_key == "selected") if (_value.type() == json::Unsigned)
+                        t.statelinked.push_back({ Selected, j["selected"].as<json::unsigned_integral>() });
+                    else errline("failed to parse \"", name, ".selected\", expecting unsigned integral.");
+                    if (_key == "pressed") if (_value.type() == json::Unsigned)
+                        t.statelinked.push_back({ Pressed, j["pressed"].as<json::unsigned_integral>() });
+                    else errline("failed to parse \"", name, ".pressed\", expecting unsigned integral.");
+                    if (_key == "focused") if (_value.type() == json::Unsigned)
+                        t.statelinked.push_back({ Focused, j["focused"].as<json::unsigned_integral>() });
+                    else errline("failed to parse \"", name, ".focused\", expecting unsigned integral.");
                 }
+            } else errline("failed to parse number \"", name, "\", expecting unsigned integer or object");
+        };
+
+        if (_theme.contains("background")) _giveColor(theme.background, _theme["background"], "theme.background");
+        if (_theme.contains("divider")) _giveColor(theme.divider, _theme["divider"], "theme.divider");
+        if (_theme.contains("border")) _giveColor(theme.border, _theme["border"], "theme.border");
+        if (_theme.contains("channel")) {
+            auto& _channel = _theme["channel"];
+            if (_channel.contains("background")) _giveColor(theme.channel.background, _channel["background"], "theme.channel.background");
+            if (_channel.contains("slider")) _giveColor(theme.channel.slider, _channel["slider"], "theme.channel.slider");
+            if (_channel.contains("meter")) {
+                auto& _meter = _channel["meter"];
+                _giveColor(theme.channel.meter, _meter, "meter");
+                if (_meter.contains("text")) _giveColor(theme.channel.meterText, _meter["text"], "theme.channel.meter.text");
+                if (_meter.contains("line1")) _giveColor(theme.channel.meterLine1, _meter["line1"], "theme.channel.meter.line1");
+                if (_meter.contains("line2")) _giveColor(theme.channel.meterLine2, _meter["line2"], "theme.channel.meter.line2");
+                if (_meter.contains("background")) _giveColor(theme.channel.meterBackground, _meter["background"], "theme.channel.meter.background");
             }
-            if (_channelId == -1) continue;
-
-            std::vector<std::string_view> _settingsVec = split(_settings, ',');
-            for (auto _setting : _settingsVec) {
-                _setting = trim(_setting);
-                auto _parts = split(_setting, '=');
-                if (_parts.size() < 2) continue; // Setting is 'name=val'
-                auto _name = trim(_parts[0]);
-                double _value = parse<double>(trim(_parts[1]));
-                auto& _c = _isInput
-                    ? static_cast<Channel&>(Controller::processor.inputs[_channelId])
-                    : static_cast<Channel&>(Controller::processor.outputs[_channelId]);
-                _c.setSetting(_name, _value);
+            if (_channel.contains("border")) {
+                auto& _border = _channel["border"];
+                _giveColor(theme.channel.border, _border, "theme.channel.border");
+                if (_border.contains("width")) _giveValue(theme.channel.borderWidth, _border["width"], "theme.channel.border.width");
             }
+            if (_channel.contains("title")) _giveColor(theme.channel.title, _channel["title"], "theme.channel.title");
+            if (_channel.contains("value")) _giveColor(theme.channel.value, _channel["value"], "theme.channel.value");
+        }
+        if (_theme.contains("routebutton")) {
+            auto& _rbttn = _theme["routebutton"];
+            if (_rbttn.contains("background")) _giveColor(theme.routebutton.background, _rbttn["background"], "theme.routebutton.background");
+            if (_rbttn.contains("border")) {
+                auto& _border = _rbttn["border"];
+                _giveColor(theme.routebutton.border, _border, "theme.routebutton.border");
+                if (_border.contains("width")) _giveValue(theme.routebutton.borderWidth, _border["width"], "theme.routebutton.border.width");
+            }
+        }
+        if (_theme.contains("close")) {
+            auto& _close = _theme["close"];
+            if (_close.contains("background")) _giveColor(theme.close.background, _close["background"], "theme.close.background");
+            if (_close.contains("icon")) _giveColor(theme.close.icon, _close["icon"], "theme.close.icon");
+        }
+        if (_theme.contains("minimize")) {
+            auto& _minimize = _theme["minimize"];
+            if (_minimize.contains("background")) _giveColor(theme.minimize.background, _minimize["background"], "theme.minimize.background");
+            if (_minimize.contains("icon")) _giveColor(theme.minimize.icon, _minimize["icon"], "theme.minimize.icon");
+        }
+        if (_theme.contains("maximize")) {
+            auto& _maximize = _theme["maximize"];
+            if (_maximize.contains("background")) _giveColor(theme.maximize.background, _maximize["background"], "theme.maximize.background");
+            if (_maximize.contains("icon")) _giveColor(theme.maximize.icon, _maximize["icon"], "theme.maximize.icon");
+        }
+        logline("loaded theme");
+        if (!headless) window->updateTheme(); // Update theme in gui
+    }
 
-            if (_parts.size() == 3) {
-                auto _outputs = trim(_parts[2], " \t\n\r\f\v[]");  // part 3: connected outputs
-                std::vector<std::string_view> _outputsVec = split(_outputs, ',');
-                for (auto _name : _outputsVec) {
-                    _name = trim(_name);
-
-                    int _outputId = -1;
-                    for (auto& _obj : _mixer->objects()) {
-                        auto _channel = _obj.as<Gui::Channel>();
-                        if (!_channel->input && _name == _channel->name) {
-                            _outputId = _channel->id;
-                            break;
-                        }
-                    }
-
+    void Controller::loadRouting() {
+        MIXIJO_TRACE("Controller::loadRouting");
+        std::vector<std::string> _lines;
+        if (std::ifstream _file{ "./routing.txt" }; _file.is_open())
+            for (std::string _str; std::getline(_file, _str);) _lines.push_back(std::move(_str));
+
+        processor.access([&](Processor::Inputs& in, Processor::Outputs& out) {
+            for (auto& _input : in)
+                for (auto& _output : _input.output_levels)
+                    _output = 0;
+
+            for (std::string_view _view : _lines) {
+                const std::optional<RoutingLine> _line = RoutingLine::parse(_view);
+                if (!_line) continue;
+
+                int _channelId = findChannel(_line->channel, _line->input);
+                if (_channelId == -1) continue;
+
+                auto& _c = _line->input
+                    ? static_cast<Channel&>(in[_channelId])
+                    : static_cast<Channel&>(out[_channelId]);
+                for (auto& [_name, _value] : _line->settings) _c.setSetting(_name, _value);
+                _c.jump = true; // Start at the loaded gain, instead of ramping to it
+
+                for (auto _name : _line->outputs) {
+                    int _outputId = findChannel(_name, false);
                     if (_outputId == -1) continue;
 
-                    Controller::processor.inputs[_channelId].output_levels[_outputId] = 1;
+                    in[_channelId].output_levels[_outputId] = 1;
                 }
             }
-        }
+        });
     }
 
-    void Controller::saveRouting() {
-        auto _mixer = window->mixer.as<Gui::Mixer>();
-
-        std::ofstream _file{ "./routing.txt" };
-        for (auto& _obj : _mixer->objects()) {
-            auto _channel = _obj.as<Gui::Channel>();
-
-            auto& _c = _channel->input
-                ? static_cast<Channel&>(Controller::processor.inputs[_channel->id])
-                : static_cast<Channel&>(Controller::processor.outputs[_channel->id]);
+    void Controller::saveRouting(bool wait) {
+        MIXIJO_TRACE("Controller::saveRouting");
+        struct Snapshot {
+            struct Entry {
+                std::string name;
+                bool input;
+                std::string settings;
+                std::vector<std::size_t> outputs; // index in outputNames
+            };
 
-            _file << _channel->name << ":[";
-            _c.getSettings(_file);
+            std::vector<Entry> channels;
+            std::vector<std::string> outputNames;
+        } _snapshot;
+
+        const auto _add = [&](Channel& channel, bool input) -> auto& {
+            auto& _entry = _snapshot.channels.emplace_back(channel.name, input);
+            std::ostringstream _settings;
+            channel.getSettings(_settings);
+            _entry.settings = _settings.str();
+            return _entry;
+        };
+
+        // Gains and crosspoints are changed by the audio thread, so only read them through read
+        processor.read([&](const Processor::Inputs& in, const Processor::Outputs& out) {
+            for (auto& _output : out) {
+                _snapshot.outputNames.push_back(_output.name);
+                _add(_output, false);
+            }
 
-            if (_channel->input) {
-                _file << "]:[";
-                bool _first = true;
-                for (auto& _obj : _mixer->objects()) {
-                    auto _output = _obj.as<Gui::Channel>();
-                    if (_output->input) continue;
+            for (auto& _input : in) {
+                auto& _entry = _add(_input, true);
+                for (std::size_t i = 0; i < _input.output_levels.size(); ++i)
+                    if (_input.output_levels[i]) _entry.outputs.push_back(i);
+            }
+        });
 
-                    auto _level = Controller::processor.inputs[_channel->id].output_levels[_output->id];
-                    if (_level) {
-                        if (!_first) _file << ",";
-                        _file << _output->name;
+        writer.post("./routing.txt", [_snapshot = std::move(_snapshot)] {
+            std::string _content;
+            for (auto& _entry : _snapshot.channels) {
+                _content += _entry.name + ":[" + _entry.settings;
+                if (_entry.input) {
+                    _content += "]:[";
+                    for (bool _first = true; std::size_t _output : _entry.outputs) {
+                        if (!_first) _content += ",";
+                        _content += _snapshot.outputNames[_output];
                         _first = false;
                     }
                 }
+                _content += "]\n";
             }
-            _file << "]\n";
+            return _content;
+        });
+
+        if (wait) writer.flush();
+    }
+
+    void Controller::dumpTrace() {
+#ifdef MIXIJO_TRACING
+        const std::string _path = std::format("logs/trace_{:%EY%Om%Od_%OH%OM%OS}.json", std::chrono::system_clock::now());
+        writer.post(_path, [_trace = Trace::dump()] { return _trace; });
+        logline("Writing trace to ", _path);
+#else
+        logline("Tracing is disabled, build with MIXIJO_TRACING to record traces");
+#endif
+    }
+
+    void Controller::indexChannels() {
+        inputChannels.clear();
+        outputChannels.clear();
+        for (int i = 0; auto& _input : processor.inputs) // First channel wins when names are duplicated
+            inputChannels.emplace(_input.name, i++);
+        for (int i = 0; auto& _output : processor.outputs)
+            outputChannels.emplace(_output.name, i++);
+    }
+
+    int Controller::findChannel(std::string_view name, bool input) {
+        auto& _channels = input ? inputChannels : outputChannels;
+        auto _it = _channels.find(name);
+        return _it == _channels.end() ? -1 : _it->second;
+    }
+
+    void Controller::loadScenes() {
+        scenes.clear();
+        std::error_code _error;
+        if (!std::filesystem::exists("scenes/", _error)) return;
+        const std::uint64_t _layout = layout();
+        for (auto& _entry : std::filesystem::directory_iterator("scenes/", _error)) {
+            if (_entry.path().extension() != ".scene") continue;
+            const std::string _name = _entry.path().stem().string();
+            std::optional<std::string> _content = readFile(_entry.path());
+            std::optional<Scene> _scene = _content ? Scene::deserialize(_content.value()) : std::nullopt;
+            if (!_scene) errline("failed to load scene (", _name, "), invalid file.");
+            else if (_scene->layout != _layout) logline("skipped scene (", _name, "), it was saved with different channels.");
+            else scenes[_name] = std::move(_scene.value());
         }
     }
 
+    bool Controller::saveScene(std::string_view name) {
+        // The name becomes a file name, so it may not leave the scenes folder
+        if (name.empty() || name.find_first_of("/\\:") != std::string_view::npos || name.contains("..")) {
+            errline("Invalid scene name (", name, "), it can't contain '/', '\\', ':' or '..'");
+            return false;
+        }
+
+        Scene _scene;
+        _scene.layout = layout();
+        processor.capture(_scene);
+
+        std::error_code _error;
+        if (!std::filesystem::exists("scenes/", _error))
+            std::filesystem::create_directory("scenes/", _error);
+        writer.post(std::format("scenes/{}.scene", name), [_data = _scene.serialize()] { return _data; });
+        scenes[std::string{ name }] = std::move(_scene);
+        logline("Saved scene (", name, ")");
+        return true;
+    }
+
+    void Controller::recallScene(std::string_view name, double ms) {
+        auto _it = scenes.find(name);
+        if (_it == scenes.end()) return errline("No scene with the name (", name, ")");
+        if (ms < 0) ms = sceneFade;
+        if (!processor.recall(_it->second, ms)) return errline("Scene (", name, ") doesn't match the channels");
+        logline("Recalled scene (", name, ")");
+    }
+
+    std::uint64_t Controller::layout() {
+        std::uint64_t _hash = 14695981039346656037ull; // FNV-1a
+        const auto _add = [&](std::string_view data) {
+            for (char _c : data) _hash = (_hash ^ static_cast<std::uint8_t>(_c)) * 1099511628211ull;
+        };
+        const auto _addChannel = [&](Channel& channel, bool input) {
+            _add(input ? "i" : "o");
+            _add(channel.name);
+            _add(std::string_view{ "\0", 1 });
+        };
+        for (auto& _output : processor.outputs) _addChannel(_output, false);
+        for (auto& _input : processor.inputs) _addChannel(_input, true);
+        return _hash;
+    }
+
     void Controller::Theme::reset() {
         background.reset();
         divider.reset();
@@ -1,6 +1,10 @@
 #include "pch.hpp"
 #include "Controller.hpp"
 
-int main() {
-    Mixijo::Controller::start();
+int main(int argc, char** argv) {
+    bool _headless = false;
+    for (int i = 1; i < argc; ++i)
+        if (std::string_view{ argv[i] } == "--headless") _headless = true;
+    Mixijo::Controller::start(_headless);
+    return Mixijo::Realtime::violations() == 0 ? 0 : 1; // Only ever fails when built with MIXIJO_RT_CHECK
 }
\ No newline at end of file
@@ -0,0 +1,58 @@
+#include "Executor.hpp"
+
+namespace Mixijo {
+
+    Executor::Executor(std::size_t threads, std::size_t capacity)
+        : _threadCount(threads), _capacity(capacity)
+    {}
+
+    Executor::~Executor() { stop(); }
+
+    void Executor::start() {
+        std::scoped_lock _{ _lock };
+        if (_running) return;
+        _running = true;
+        for (std::size_t i = 0; i < _threadCount; ++i)
+            _threads.emplace_back([this] { run(); });
+    }
+
+    void Executor::stop() {
+        {
+            std::scoped_lock _{ _lock };
+            _running = false;
+        }
+        _condition.notify_all();
+        for (auto& _thread : _threads) _thread.join();
+        _threads.clear();
+        _jobs.clear();
+    }
+
+    bool Executor::submit(Job job) {
+        {
+            std::scoped_lock _{ _lock };
+            if (!_running || _jobs.size() >= _capacity) return false;
+            _jobs.push_back(std::move(job));
+        }
+        _condition.notify_one();
+        return true;
+    }
+
+    bool Executor::running() {
+        std::scoped_lock _{ _lock };
+        return _running;
+    }
+
+    void Executor::run() {
+        while (true) {
+            Job _job;
+            {
+                std::unique_lock _guard{ _lock };
+                _condition.wait(_guard, [&] { return !_running || !_jobs.empty(); });
+                if (!_running) return;
+                _job = std::move(_jobs.front());
+                _jobs.pop_front();
+            }
+            _job();
+        }
+    }
+}
@@ -4,8 +4,8 @@
 namespace Mixijo::Gui {
 
 
-    Channel::Channel(int _id, bool in, std::string_view name)
-        : id(_id), input(in), name(name), route(emplace<RouteButton>())
+    Channel::Channel(int _id, bool in)
+        : id(_id), input(in), route(emplace<RouteButton>())
     {
         link(background);
         link(meter);
@@ -38,6 +38,11 @@ namespace Mixijo::Gui {
         updateTheme();
     }
 
+    Mixijo::Channel& Channel::model() const {
+        if (input) return Controller::processor.inputs[id];
+        return Controller::processor.outputs[id];
+    }
+
     void Channel::mousePress(const MousePress& e) {
         pressGain = std::pow(input
             ? Controller::processor.inputs[id].gain
@@ -48,8 +53,9 @@ namespace Mixijo::Gui {
         auto& _val = input
             ? Controller::processor.inputs[id].gain
             : Controller::processor.outputs[id].gain;
-        if (counter > 0) _val = 1;
-        if (!route->get(Hovering)) counter = 20;
+        const auto _now = std::chrono::steady_clock::now();
+        if (_now - lastClick < doubleClick) _val = 1;
+        if (!route->get(Hovering)) lastClick = _now;
     }
 
     Dimensions<int> Channel::bars() const {
@@ -72,6 +78,7 @@ namespace Mixijo::Gui {
     }
 
     void Channel::draw(DrawContext& p) const {
+        if (!visible) return;
         // Background
         p.strokeWeight(borderWidth);
         p.stroke(border);
@@ -82,7 +89,7 @@ namespace Mixijo::Gui {
         p.font(Font::Default);
         p.fontSize(14);
         p.textAlign(Align::Center);
-        p.text(name, dimensions().inset(12).topCenter());
+        p.text(model().name, dimensions().inset(12).topCenter());
 
         const int _padding = 2;
         const auto _bars = bars();
@@ -91,49 +98,50 @@ namespace Mixijo::Gui {
             return _bars.height() * std::clamp(std::pow(lin, 0.25) / Controller::maxLin, 0., 1.);
         };
 
-        const auto db2y = [&](float db) { return lin2y(db2lin(db)); };
-
         float _bottom = _bars.y() + _bars.height();
         int _x = _bars.x();
         p.strokeWeight(0);
-        for (std::size_t i = 0; i < smoothed.size(); ++i) {
-            int _w = (_bars.width() + _padding) * 1. / smoothed.size();
-            float _h = std::floor(lin2y(smoothed[i])) - 0.3;
-            float _y = _bottom - _h;
+        if (_analyzed) { // Spectrum instead of the meters, low to high frequencies from left to right
+            const float _w = static_cast<float>(_bars.width()) / Spectrum::Bands;
             p.fill(meterBackground);
-            p.rect(Dimensions{ _x, _bars.y(), _w - _padding, _bars.height() });
-            p.fill(meter);
-            p.rect(Dimensions{ _x, _y, _w - _padding, _h });
-            _x += _w;
+            p.rect(Dimensions{ _bars.x(), _bars.y(), _bars.width(), _bars.height() });
+            for (std::size_t i = 0; i < Spectrum::Bands; ++i) {
+                const float _bx = _bars.x() + i * _w;
+                const float _h = std::floor(lin2y(db2lin(_spectrum.level[i])));
+                const float _peak = std::floor(lin2y(db2lin(_spectrum.peak[i])));
+                p.fill(meter);
+                p.rect(Dimensions{ _bx, _bottom - _h, _w, _h });
+                p.fill(meterLine1);
+                p.rect(Dimensions{ _bx, _bottom - _peak - 1, _w, 1.f });
+            }
+            _x = _bars.x() + _bars.width() + _padding;
+        } else {
+            for (std::size_t i = 0; i < smoothed.size(); ++i) {
+                int _w = (_bars.width() + _padding) * 1. / smoothed.size();
+                float _h = std::floor(lin2y(smoothed[i])) - 0.3;
+                float _y = _bottom - _h;
+                p.fill(meterBackground);
+                p.rect(Dimensions{ _x, _bars.y(), _w - _padding, _bars.height() });
+                p.fill(meter);
+                p.rect(Dimensions{ _x, _y, _w - _padding, _h });
+                _x += _w;
+            }
         }
         p.fill(background);
         p.rect(Dimensions{ _bars.x(), _bars.bottom() - 1, _bars.width(), 2});
-        constexpr static std::array dB1{ 12.,                6.,               0.,                  -6.,                   -12.,                     -18.,                     -24.,                   -36.,                   -48.,                   -72. };
-        constexpr static std::array dB2{ 12.,       9.,      6.,      3.,      0.,       -3.,       -6.,       -9.,        -12.,        -15.,        -18.,        -21.,        -24.,       -30.,       -36.,       -42.,       -48.,       -60.,       -72.,       -96. };
-        constexpr static std::array dB3{ 12., 10.5, 9., 7.5, 6., 4.5, 3., 1.5, 0., -1.5, -3., -4.5, -6., -7.5, -9., -10.5, -12., -13.5, -15., -16.5, -18., -19.5, -21., -22.5, -24., -27., -30., -33., -36., -39., -42., -45., -48., -54., -60., -66., -72., -84., -96., -108. };
-        const static std::array begins{ dB1.data(), dB2.data(), dB3.data() };
-        const static std::array sizes{ dB1.size(), dB2.size(), dB3.size() };
-
-        int _type = _bars.height() < 250 ? 0 : _bars.height() < 500 ? 1 : 2;
-
-        auto _begin = begins[_type];
-        auto _size = sizes[_type];
-        bool _b = true;
 
+        layoutScale(_bars);
         p.fontSize(14);
         p.textAlign(Align::Right | Align::CenterY);
         p.strokeWeight(1.5);
-        for (int i = 0; i < _size; ++i) {
-            auto _dB = _begin[i];
-            float _mdb = 0.5 + std::floor(_bars.height() + _bars.y() - db2y(_dB));
-            if (_b) {
+        for (auto& _tick : _scaleTicks) {
+            if (_tick.label) {
                 p.fill(meterText);
-                p.text(NUMBERS[std::abs(_dB)], { _x + 25, _mdb });
+                p.text(_tick.label, { _x + 25, _tick.y });
                 p.stroke(meterLine1);
             }
             else p.stroke(meterLine2);
-            p.line({ _x, _mdb }, { _x + 5.f, _mdb });
-            _b ^= true;
+            p.line({ _x, _tick.y }, { _x + 5.f, _tick.y });
         }
 
         p.stroke(meterLine1);
@@ -142,9 +150,8 @@ namespace Mixijo::Gui {
         p.text("inf", { _x + 25, _bars.bottom() - 1 });
         p.strokeWeight(0);
 
-        auto _0y = _bars.height() + _bars.y() - lin2y(1);
         p.fill(background);
-        p.rect(Dimensions{ _bars.x(), _0y, _bars.width(), 1 });
+        p.rect(Dimensions{ _bars.x(), _scaleZero, _bars.width(), 1 });
 
         auto _gain = input
             ? Controller::processor.inputs[id].gain
@@ -170,28 +177,85 @@ namespace Mixijo::Gui {
         Object::draw(p);
     }
 
+    void Channel::layoutScale(const Dimensions<int>& bars) const {
+        if (sameDimensions(bars, _scaleBars)) return;
+        _scaleBars = bars;
+
+        const auto lin2y = [&](float lin) {
+            return bars.height() * std::clamp(std::pow(lin, 0.25) / Controller::maxLin, 0., 1.);
+        };
+
+        const auto db2y = [&](float db) { return lin2y(db2lin(db)); };
+
+        constexpr static std::array dB1{ 12.,                6.,               0.,                  -6.,                   -12.,                     -18.,                     -24.,                   -36.,                   -48.,                   -72. };
+        constexpr static std::array dB2{ 12.,       9.,      6.,      3.,      0.,       -3.,       -6.,       -9.,        -12.,        -15.,        -18.,        -21.,        -24.,       -30.,       -36.,       -42.,       -48.,       -60.,       -72.,       -96. };
+        constexpr static std::array dB3{ 12., 10.5, 9., 7.5, 6., 4.5, 3., 1.5, 0., -1.5, -3., -4.5, -6., -7.5, -9., -10.5, -12., -13.5, -15., -16.5, -18., -19.5, -21., -22.5, -24., -27., -30., -33., -36., -39., -42., -45., -48., -54., -60., -66., -72., -84., -96., -108. };
+        const static std::array begins{ dB1.data(), dB2.data(), dB3.data() };
+        const static std::array sizes{ dB1.size(), dB2.size(), dB3.size() };
+
+        int _type = bars.height() < 250 ? 0 : bars.height() < 500 ? 1 : 2;
+
+        auto _begin = begins[_type];
+        auto _size = sizes[_type];
+        bool _b = true;
+
+        _scaleTicks.clear();
+        for (int i = 0; i < _size; ++i) {
+            auto _dB = _begin[i];
+            float _mdb = 0.5 + std::floor(bars.height() + bars.y() - db2y(_dB));
+            _scaleTicks.push_back({ _mdb, _b ? NUMBERS[std::abs(_dB)] : nullptr });
+            _b ^= true;
+        }
+
+        _scaleZero = bars.height() + bars.y() - lin2y(1);
+    }
+
+    void Channel::hide() {
+        visible = false;
+        dimensions({ -1000, -1000, 0, 0 }); // Out of sight, so it never gets hovered
+        route->dimensions({ -1000, -1000, 0, 0 });
+        _layout = { 0, 0, -1, -1 }; // Place the route button again when shown
+    }
+
     void Channel::update() {
-        counter--;
+        if (!sameDimensions(dimensions(), _layout)) { // Only move the route button when this channel moved
+            _layout = dimensions();
+            route->dimensions({ x() + 5, y() + height() - 30, width() - 10, 25 });
+        }
+        const auto _now = std::chrono::steady_clock::now();
+        const double _elapsed = std::chrono::duration<double>(_now - lastUpdate).count();
+        lastUpdate = _now;
         auto ane = get(Selected);
         auto& _channel = input
             ? static_cast<Mixijo::Channel&>(Controller::processor.inputs[id])
             : static_cast<Mixijo::Channel&>(Controller::processor.outputs[id]);
 
-        auto _db = input
-            ? lin2db(Controller::processor.inputs[id].gain)
-            : lin2db(Controller::processor.outputs[id].gain);
-        if (_db < -120) gain = "-inf dB";
-        else gain = std::format("{:.1f}", _db) + "dB";
+        if (_channel.gain != _shownGain) { // Only format the gain text when it changed
+            _shownGain = _channel.gain;
+            auto _db = lin2db(_channel.gain);
+            if (_db < -120) gain = "-inf dB";
+            else gain = std::format("{:.1f}", _db) + "dB";
+        }
+
+        _analyzed = Controller::processor.analyzer.opened(input, id);
+        if (_analyzed) {
+            const Spectrum& _latest = Controller::processor.analyzer.read();
+            if (_latest.input == input && _latest.channel == id) _spectrum = _latest;
+            else { // Nothing analyzed yet
+                _spectrum.level.fill(Spectrum::Floor);
+                _spectrum.peak.fill(Spectrum::Floor);
+            }
+        }
 
-        smoothed.resize(_channel.peaks.size());
+        smoothed.resize(_channel.held.size());
 
+        // Smooth over time instead of per frame, so the meters look the same at any frame rate
+        const double _keep = std::exp(-std::min(_elapsed, 1.) / meterTime);
         for (std::size_t i = 0; i < smoothed.size(); ++i) {
-            smoothed[i] = smoothed[i] * 0.8 + 0.2 * _channel.peaks[i];
-            _channel.peaks[i] = 0;
+            smoothed[i] = _channel.held[i] + (smoothed[i] - _channel.held[i]) * _keep;
+            _channel.held[i] = 0;
         }
 
-        route->dimensions({ x() + 5, y() + height() - 30, width() - 10, 25 });
-
         if (Controller::selectedChannel != -1) {
             route->set(Disabled, Controller::selectedInput == input);
             if (input && !Controller::selectedInput) {
@@ -70,8 +70,14 @@ namespace Mixijo {
     }
 
     void Frame::update() {
+        MIXIJO_TRACE("Frame::update");
         if (!initialResize) width(width()), initialResize = true;
-        if (IsMaximized(m_Handle)) {
+        const bool _maximized = IsMaximized(m_Handle);
+        if (sameDimensions(Dimensions<float>{ 0, 0, width(), height() }, layout) && _maximized == layoutMaximized)
+            return Window::update(); // Only place the children when resized or (un)maximized
+        layout = { 0, 0, width(), height() };
+        layoutMaximized = _maximized;
+        if (_maximized) {
             mixer->dimensions({ 16, 40, width() - 32, height() - 56 });
             close->dimensions({ width() - 45 * 1 - 8, 8, 45, 29 });
             maximize->dimensions({ width() - 45 * 2 - 8, 8, 45, 29 });
@@ -86,6 +92,10 @@ namespace Mixijo {
         Window::update();
     }
 
+    bool Frame::minimized() const {
+        return IsIconic(m_Handle);
+    }
+
     void Frame::updateTheme() {
         Controller::theme.border.assign(border);
         Controller::theme.close.background.assign(close->background);
@@ -38,26 +38,56 @@ namespace Mixijo::Gui {
         p.strokeWeight(0);
         p.fill(background);
         p.rect(dimensions());
-        p.fill(divider);
-        p.rect(Dimensions{ dividerX, y(), 2, height() });
+        if (dividerX >= 0) {
+            p.fill(divider);
+            p.rect(Dimensions{ dividerX, y(), 2, height() });
+        }
         Object::draw(p);
     }
 
     void Mixer::update()  {
         auto& _objects = objects();
+        // Only place the channels when the mixer was resized or channels were added or removed
+        if (_layoutValid && _layoutCount == _objects.size() && sameDimensions(dimensions(), _layout))
+            return updateVisible();
+        _layoutValid = true;
+        _layoutCount = _objects.size();
+        _layout = dimensions();
+
+        dividerX = -1;
+        if (_objects.empty()) return;
+
         constexpr auto _padding = 4;
         constexpr auto _outerPadding = 8;
         float _x = x() + _outerPadding;
         float _y = y() + _outerPadding;
         float _h = height() - _outerPadding * 2;
-        float _w = (width() - _outerPadding - 4 * _padding - 2) / _objects.size();
+        const float _available = width() - _outerPadding - 4 * _padding - 2;
+
+        // When the channels don't fit, only show a bank of channels that do
+        std::size_t _fit = _objects.size();
+        float _w = _available / _fit;
+        if (_w < minWidth) {
+            _fit = std::max(static_cast<std::size_t>(_available / minWidth), std::size_t{ 1 });
+            _w = _available / _fit;
+        }
+        first = std::min(first, _objects.size() - _fit);
+        _bank = _fit;
+
         bool _outputs = true;
-        for (auto& _obj : _objects) {
-            auto _channel = _obj.as<Channel>();
+        for (std::size_t i = 0; i < _objects.size(); ++i) {
+            auto _channel = _objects[i].as<Channel>();
+            if (i < first || i >= first + _fit) {
+                if (_channel->input) _outputs = false;
+                _channel->hide();
+                continue;
+            }
+            _channel->visible = true;
+
             if (_channel->input && _outputs) {
                 _outputs = false;
                 _x += _padding;
-                dividerX = _x;
+                if (i != first) dividerX = _x;
                 _x += 2;
                 _x += _padding;
                 _x += _padding;
@@ -68,7 +98,21 @@ namespace Mixijo::Gui {
             _channel->width(_w - _padding);
             _x += _w;
         }
-        Object::update();
+        updateVisible();
+    }
+
+    void Mixer::updateVisible() {
+        // Hidden channels aren't updated at all, their meters catch up when they're shown again
+        for (auto& _obj : objects()) {
+            auto _channel = _obj.as<Channel>();
+            if (_channel->visible) _channel->update();
+        }
+    }
+
+    void Mixer::mouseWheel(const MouseWheel& e) {
+        if (e.amount > 0 && first > 0) --first;
+        else if (e.amount < 0 && first + _bank < objects().size()) ++first;
+        invalidate();
     }
 
     void Mixer::updateTheme() {
@@ -0,0 +1,175 @@
+#include "Jack/Client.hpp"
+#include "Processing/Routing.hpp"
+#include "Realtime.hpp"
+#include "Trace.hpp"
+
+namespace Mixijo::Jack {
+
+    template<class ...Args>
+    static void errline(Args&&... args) {
+        ((std::cerr << "[Mixijo] [error] ") << ... << args) << '\n';
+    }
+
+    Client::~Client() {
+        close();
+    }
+
+    bool Client::open(std::string_view name, json& settings, std::string_view server) {
+        close();
+        const std::string _name{ name };
+        const std::string _server{ server };
+        const auto _options = static_cast<jack_options_t>(JackNoStartServer | (_server.empty() ? 0 : JackServerName));
+        jack_status_t _status{};
+        _client = jack_client_open(_name.c_str(), _options, &_status, _server.c_str());
+        if (!_client) {
+            errline("Couldn't open the JACK client \"", _name, "\", is the server running? (status ", static_cast<int>(_status), ")");
+            return false;
+        }
+        _shutdown = false;
+
+        // Built like Controller::applyChannels, but the endpoints are ports of this client
+        graph = Graph{};
+        const double _sampleRate = jack_get_sample_rate(_client);
+        bool _registered = true;
+        const auto _addChannel = [&](json& channel, bool input) {
+            auto& _channel = input ? (Channel&) graph.inputs.emplace_back() : graph.outputs.emplace_back();
+            _channel.prepare(_sampleRate);
+            if (channel.contains("name", json::String)) _channel.name = channel["name"].as<json::string>();
+            if (!channel.contains("endpoints", json::Array)) return;
+            for (auto& _endpoint : channel["endpoints"].as<json::array>()) if (_endpoint.is(json::String)) {
+                const int _id = endpoint(_endpoint.as<json::string>(), input);
+                if (_id != -1) _channel.add(_id);
+                else _registered = false;
+            }
+        };
+
+        if (settings.contains("channels", json::Object)) {
+            auto& _channels = settings["channels"];
+            if (_channels.contains("outputs", json::Array))
+                for (auto& _channel : _channels["outputs"].as<json::array>())
+                    _addChannel(_channel, false);
+            if (_channels.contains("inputs", json::Array))
+                for (auto& _channel : _channels["inputs"].as<json::array>())
+                    _addChannel(_channel, true);
+        }
+
+        if (!_registered) {
+            close();
+            return false;
+        }
+
+        graph.layout();
+        resize(jack_get_buffer_size(_client));
+        jack_set_process_callback(_client, process, this);
+        jack_set_buffer_size_callback(_client, bufferSize, this);
+        jack_on_shutdown(_client, shutdown, this);
+        return true;
+    }
+
+    void Client::route(const std::vector<std::string>& lines) {
+        const auto _find = [](auto& channels, std::string_view name) -> int {
+            const auto _it = std::ranges::find(channels, name, &Channel::name);
+            return _it == channels.end() ? -1 : static_cast<int>(_it - channels.begin());
+        };
+
+        for (auto& _input : graph.inputs) std::ranges::fill(_input.output_levels, 0);
+        for (std::string_view _view : lines) {
+            const std::optional<RoutingLine> _line = RoutingLine::parse(_view);
+            if (!_line) continue;
+
+            const int _id = _line->input ? _find(graph.inputs, _line->channel) : _find(graph.outputs, _line->channel);
+            if (_id == -1) continue;
+
+            auto& _channel = _line->input
+                ? static_cast<Channel&>(graph.inputs[_id])
+                : static_cast<Channel&>(graph.outputs[_id]);
+            for (auto& [_name, _value] : _line->settings) _channel.setSetting(_name, _value);
+            _channel.smoothedGain = _channel.gain; // Start at the loaded gain, instead of ramping to it
+
+            for (auto _name : _line->outputs)
+                if (const int _output = _find(graph.outputs, _name); _output != -1)
+                    graph.inputs[_id].output_levels[_output] = 1;
+        }
+    }
+
+    bool Client::activate() {
+        if (!_client) return false;
+        if (jack_activate(_client) == 0) return true;
+        errline("Couldn't activate the JACK client");
+        return false;
+    }
+
+    void Client::close() {
+        if (!_client) return;
+        jack_deactivate(_client);
+        jack_client_close(_client); // Also unregisters the ports
+        _client = nullptr;
+        _inputs.clear();
+        _outputs.clear();
+        _inputNames.clear();
+        _outputNames.clear();
+    }
+
+    std::vector<std::string> Client::ports(bool input) const {
+        std::vector<std::string> _names;
+        for (jack_port_t* _port : input ? _inputs : _outputs) _names.emplace_back(jack_port_name(_port));
+        return _names;
+    }
+
+    int Client::endpoint(std::string_view name, bool input) {
+        auto& _names = input ? _inputNames : _outputNames;
+        if (const auto _it = std::ranges::find(_names, name); _it != _names.end())
+            return static_cast<int>(_it - _names.begin()); // Channels can share an endpoint
+
+        const std::string _port = (input ? "in " : "out ") + std::string(name);
+        jack_port_t* _registered = jack_port_register(_client, _port.c_str(), JACK_DEFAULT_AUDIO_TYPE, input ? JackPortIsInput : JackPortIsOutput, 0);
+        if (!_registered) {
+            errline("Couldn't register the JACK port \"", _port, "\"");
+            return -1;
+        }
+
+        (input ? _inputs : _outputs).push_back(_registered);
+        _names.emplace_back(name);
+        return static_cast<int>(_names.size() - 1);
+    }
+
+    void Client::resize(std::size_t frames) {
+        // JACK doesn't run the process callback while the buffer size changes
+        _in = std::make_unique<Buffer<double>>(_inputs.size(), frames);
+        _out = std::make_unique<Buffer<double>>(_outputs.size(), frames);
+    }
+
+    int Client::process(jack_nframes_t frames, void* self) {
+        MIXIJO_REALTIME();
+        {
+            MIXIJO_REALTIME_ALLOW();
+            MIXIJO_TRACE_THREAD("audio");
+        }
+        MIXIJO_TRACE("Jack::Client::process");
+        auto& _self = *static_cast<Client*>(self);
+        auto& _in = *_self._in;
+        auto& _out = *_self._out;
+
+        if (_out.Frames() != frames) { // Missed a buffer size change, never expected
+            for (jack_port_t* _port : _self._outputs)
+                std::fill_n(static_cast<float*>(jack_port_get_buffer(_port, frames)), frames, 0.f);
+            return 0;
+        }
+
+        for (std::size_t i = 0; i < _self._inputs.size(); ++i)
+            std::copy_n(static_cast<const float*>(jack_port_get_buffer(_self._inputs[i], frames)), frames, _in.data()[i]);
+        _self.graph.process(_in, _out);
+        for (std::size_t i = 0; i < _self._outputs.size(); ++i)
+            std::copy_n(_out.data()[i], frames, static_cast<float*>(jack_port_get_buffer(_self._outputs[i], frames)));
+        return 0;
+    }
+
+    int Client::bufferSize(jack_nframes_t frames, void* self) {
+        static_cast<Client*>(self)->resize(frames);
+        return 0;
+    }
+
+    void Client::shutdown(void* self) {
+        static_cast<Client*>(self)->_shutdown = true;
+    }
+}
@@ -0,0 +1,46 @@
+#include "Jack/Client.hpp"
+#include <csignal>
+
+// Runs the engine as a JACK client on Linux, with the channels of settings.json and the
+// routing of routing.txt in the working directory. The JACK server picks the sample rate and
+// buffer size, so "samplerate" and "buffersize" are ignored, and there's no gui or midi.
+namespace Mixijo::Jack {
+    static std::atomic<bool> stopped{ false };
+}
+
+int main(int argc, char** argv) {
+    using namespace Mixijo;
+    std::string_view _name = "Mixijo";
+    std::string_view _server{};
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::string_view{ argv[i] } == "--name") _name = argv[i + 1];
+        else if (std::string_view{ argv[i] } == "--server") _server = argv[i + 1];
+    }
+
+    std::optional<std::string> _content = readFile("./settings.json");
+    std::optional<json> _settings = _content ? json::parse(_content.value()) : std::nullopt;
+    if (!_settings) {
+        std::cerr << "[Mixijo] [error] cannot read settings.json, or it's invalid json\n";
+        return 1;
+    }
+
+    Jack::Client _client;
+    if (!_client.open(_name, _settings.value(), _server)) return 1;
+
+    std::vector<std::string> _routing;
+    if (std::ifstream _file{ "./routing.txt" }; _file.is_open())
+        for (std::string _line; std::getline(_file, _line);) _routing.push_back(std::move(_line));
+    _client.route(_routing);
+    if (!_client.activate()) return 1;
+
+    std::signal(SIGINT, [](int) { Jack::stopped = true; });
+    std::signal(SIGTERM, [](int) { Jack::stopped = true; });
+    std::cout << "[Mixijo] [log] running as JACK client \"" << _name << "\", stop with CTRL + C\n";
+    while (!Jack::stopped && _client.running())
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    const bool _dropped = !_client.running();
+    if (_dropped) std::cerr << "[Mixijo] [error] the JACK server stopped or dropped the client\n";
+    _client.close();
+    return _dropped ? 1 : 0;
+}
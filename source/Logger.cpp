@@ -0,0 +1,62 @@
+#include "Logger.hpp"
+#include "Controller.hpp"
+
+namespace Mixijo {
+
+    Logger::Logger(std::chrono::milliseconds interval)
+        : _interval(interval)
+    {}
+
+    Logger::~Logger() { stop(); }
+
+    void Logger::start() {
+        if (_running.exchange(true)) return;
+        _thread = std::thread{ [this] { run(); } };
+    }
+
+    void Logger::stop() {
+        if (!_running.exchange(false)) return;
+        _thread.join();
+    }
+
+    void Logger::run() {
+        while (_running) {
+            write();
+            std::this_thread::sleep_for(_interval);
+        }
+        write(); // Write what's left before stopping
+    }
+
+    void Logger::write() {
+        constexpr auto _prefix = [](std::chrono::system_clock::time_point time, Level level) {
+            return std::format("[Mixijo] {:%EY-%Om-%Od %OH:%OM:%OS} [{}] ", time, level == Error ? "err" : "log");
+        };
+
+        std::string _batch;
+        for (Record _record; _records.pop(_record);) {
+            _batch += _prefix(_record.time, _record.level);
+            for (std::size_t i = 0; i < _record.count; ++i) {
+                auto& _arg = _record.arguments[i];
+                switch (_arg.type) {
+                case Argument::Text: _batch += _arg.text; break;
+                case Argument::Signed: _batch += std::to_string(_arg.integral); break;
+                case Argument::Unsigned: _batch += std::to_string(_arg.unsigned_integral); break;
+                case Argument::Floating: _batch += std::format("{}", _arg.floating); break;
+                case Argument::Boolean: _batch += _arg.boolean ? "1" : "0"; break;
+                }
+            }
+            _batch += '\n';
+        }
+
+        if (const std::size_t _count = dropped(); _count != _reported) {
+            _reported = _count;
+            _batch += _prefix(std::chrono::system_clock::now(), Error);
+            _batch += std::format("Logger can't keep up, dropped {} messages in total\n", _count);
+        }
+
+        if (_batch.empty()) return;
+        std::scoped_lock _{ Controller::logLock };
+        std::cout << _batch << std::flush;
+        if (Controller::logOutput.is_open()) Controller::logOutput << _batch << std::flush;
+    }
+}
@@ -0,0 +1,200 @@
+#include "Processing/Analyzer.hpp"
+#include "Trace.hpp"
+#include "Scheduling.hpp"
+
+namespace Mixijo {
+
+    Analyzer::~Analyzer() { close(); }
+
+    void Analyzer::open(bool input, int channel, double sampleRate) {
+        close();
+        const int _encoded = encode(input, channel);
+        _sampleRate = sampleRate;
+        _target.store(_encoded, std::memory_order_release);
+        _running = true;
+        _thread = std::thread{ [this, _encoded] { run(_encoded); } };
+    }
+
+    void Analyzer::close() {
+        _target.store(-1, std::memory_order_release);
+        _running = false;
+        if (_thread.joinable()) _thread.join();
+    }
+
+    bool Analyzer::opened(bool input, int channel) const {
+        return _target.load(std::memory_order_relaxed) == encode(input, channel);
+    }
+
+    void Analyzer::tap(std::span<const double> values, double gain) {
+        const int _current = _target.load(std::memory_order_relaxed);
+        if (_current != _block.target) { // Never mix samples of different channels in a block
+            _block.target = _current;
+            _filled = 0;
+        }
+
+        double _sum = 0;
+        for (double _value : values) _sum += _value;
+        _block.samples[_filled++] = values.empty() ? 0.f : static_cast<float>(_sum * gain / values.size());
+
+        if (_filled == BlockSize) {
+            _blocks.push(_block); // Dropped when the analysis thread can't keep up
+            _filled = 0;
+        }
+    }
+
+    void Analyzer::run(int target) {
+        MIXIJO_TRACE_THREAD("analyzer");
+        prepare();
+        while (_running) {
+            Scheduling::apply(Scheduling::Analyzer);
+            for (Block _block; _blocks.pop(_block);) {
+                if (_block.target != target) continue; // Tapped before this channel was opened
+                for (float _sample : _block.samples) {
+                    _history[_position] = _sample;
+                    _position = (_position + 1) % Size;
+                    if (++_pending == Hop) {
+                        _pending = 0;
+                        analyze(target);
+                    }
+                }
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+
+    void Analyzer::prepare() {
+        constexpr std::size_t _half = Size / 2;
+        constexpr double _pi = 3.14159265358979323846;
+
+        _history.assign(Size, 0.f);
+        _position = 0;
+        _pending = 0;
+
+        _window.resize(Size);
+        for (std::size_t i = 0; i < Size; ++i) // Periodic Hann window
+            _window[i] = static_cast<float>(0.5 - 0.5 * std::cos(2 * _pi * i / Size));
+
+        _real.resize(_half);
+        _imag.resize(_half);
+        _power.resize(_half + 1);
+
+        // e^(-2 pi i k / Size), the FFT of half the size uses every other one
+        _cos.resize(_half);
+        _sin.resize(_half);
+        for (std::size_t k = 0; k < _half; ++k) {
+            _cos[k] = static_cast<float>(std::cos(2 * _pi * k / Size));
+            _sin[k] = static_cast<float>(std::sin(2 * _pi * k / Size));
+        }
+
+        _reversed.resize(_half);
+        std::size_t _bits = 0;
+        while ((std::size_t{ 1 } << _bits) < _half) ++_bits;
+        for (std::size_t i = 0; i < _half; ++i) {
+            std::size_t _reverse = 0;
+            for (std::size_t b = 0; b < _bits; ++b)
+                if (i & (std::size_t{ 1 } << b)) _reverse |= std::size_t{ 1 } << (_bits - 1 - b);
+            _reversed[i] = _reverse;
+        }
+
+        // Bands are spaced logarithmically, a band narrower than a bin uses the nearest bin
+        const double _binWidth = _sampleRate / Size;
+        const double _ratio = Spectrum::MaxFrequency / Spectrum::MinFrequency;
+        for (std::size_t b = 0; b < Spectrum::Bands; ++b) {
+            const double _low = Spectrum::MinFrequency * std::pow(_ratio, static_cast<double>(b) / Spectrum::Bands);
+            const double _high = Spectrum::MinFrequency * std::pow(_ratio, static_cast<double>(b + 1) / Spectrum::Bands);
+            auto _first = static_cast<std::size_t>(std::ceil(_low / _binWidth));
+            auto _last = static_cast<std::size_t>(std::floor(_high / _binWidth));
+            if (_first > _last) _first = _last = static_cast<std::size_t>(std::round(std::sqrt(_low * _high) / _binWidth));
+            if (_first > _half) _bands[b] = { 1, 0 }; // Above nyquist, stays empty
+            else _bands[b] = { _first, std::min(_last, _half) };
+        }
+
+        _peaks.fill(Spectrum::Floor);
+        _held.fill(0);
+    }
+
+    void Analyzer::analyze(int target) {
+        MIXIJO_TRACE("Analyzer::analyze");
+        constexpr std::size_t _half = Size / 2;
+
+        // Oldest sample first, the even samples go in the real part and the odd samples
+        // in the imaginary part, so a complex FFT of half the size does the real FFT
+        for (std::size_t i = 0; i < _half; ++i) {
+            _real[i] = _history[(_position + 2 * i) % Size] * _window[2 * i];
+            _imag[i] = _history[(_position + 2 * i + 1) % Size] * _window[2 * i + 1];
+        }
+
+        transform();
+
+        // Split the result into the spectrum of the real signal, X[k] = E[k] + W^k O[k]
+        // A full scale sine is 0 dB: amplitude = 2 |X| / sum(window) = 4 |X| / Size
+        constexpr float _scale = 16.f / (static_cast<float>(Size) * Size);
+        for (std::size_t k = 0; k <= _half; ++k) {
+            const std::size_t _a = k % _half, _b = (_half - k) % _half;
+            const float _evenReal = 0.5f * (_real[_a] + _real[_b]);
+            const float _evenImag = 0.5f * (_imag[_a] - _imag[_b]);
+            const float _oddReal = 0.5f * (_imag[_a] + _imag[_b]);
+            const float _oddImag = -0.5f * (_real[_a] - _real[_b]);
+            const float _wReal = k == _half ? -1.f : _cos[k];
+            const float _wImag = k == _half ? 0.f : -_sin[k];
+            const float _xReal = _evenReal + _wReal * _oddReal - _wImag * _oddImag;
+            const float _xImag = _evenImag + _wReal * _oddImag + _wImag * _oddReal;
+            _power[k] = (_xReal * _xReal + _xImag * _xImag) * _scale;
+        }
+
+        const auto _holdHops = static_cast<std::size_t>(PeakHold * _sampleRate / Hop);
+        const auto _decay = static_cast<float>(PeakDecay * Hop / _sampleRate);
+
+        Spectrum& _spectrum = _spectra.write();
+        const Target _target = decode(target);
+        _spectrum.input = _target.input;
+        _spectrum.channel = _target.channel;
+        for (std::size_t b = 0; b < Spectrum::Bands; ++b) {
+            float _max = 0;
+            for (std::size_t k = _bands[b].first; k <= _bands[b].second; ++k)
+                _max = std::max(_max, _power[k]);
+            const float _level = _max > 0 ? std::max(10.f * std::log10(_max), Spectrum::Floor) : Spectrum::Floor;
+
+            if (_level >= _peaks[b]) {
+                _peaks[b] = _level;
+                _held[b] = _holdHops;
+            } else if (_held[b] > 0) --_held[b];
+            else _peaks[b] = std::max(_peaks[b] - _decay, Spectrum::Floor);
+
+            _spectrum.level[b] = _level;
+            _spectrum.peak[b] = _peaks[b];
+        }
+        _spectra.publish();
+    }
+
+    void Analyzer::transform() {
+        constexpr std::size_t _half = Size / 2;
+
+        for (std::size_t i = 0; i < _half; ++i) {
+            const std::size_t j = _reversed[i];
+            if (i < j) {
+                std::swap(_real[i], _real[j]);
+                std::swap(_imag[i], _imag[j]);
+            }
+        }
+
+        // Iterative radix-2, the twiddle of k in a stage of this size is e^(-2 pi i k / size)
+        for (std::size_t _size = 2; _size <= _half; _size *= 2) {
+            const std::size_t _step = Size / _size;
+            const std::size_t _span = _size / 2;
+            for (std::size_t _start = 0; _start < _half; _start += _size) {
+                for (std::size_t k = 0; k < _span; ++k) {
+                    const float _wReal = _cos[k * _step];
+                    const float _wImag = -_sin[k * _step];
+                    const std::size_t _a = _start + k, _b = _a + _span;
+                    const float _tReal = _real[_b] * _wReal - _imag[_b] * _wImag;
+                    const float _tImag = _real[_b] * _wImag + _imag[_b] * _wReal;
+                    _real[_b] = _real[_a] - _tReal;
+                    _imag[_b] = _imag[_a] - _tImag;
+                    _real[_a] += _tReal;
+                    _imag[_a] += _tImag;
+                }
+            }
+        }
+    }
+}
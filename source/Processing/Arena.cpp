@@ -0,0 +1,30 @@
+#include "Processing/Arena.hpp"
+
+namespace Mixijo {
+
+    Arena::Arena(std::size_t size)
+        : _data(static_cast<double*>(::operator new[](std::max(size, std::size_t{ 1 }) * sizeof(double), std::align_val_t{ Alignment }))),
+        _size(size)
+    {
+        std::fill_n(_data.get(), _size, 0.);
+    }
+
+    void Arena::lock() {
+        if (_data.get_deleter().locked) return;
+        if (Scheduling::lock(_data.get(), _size * sizeof(double)))
+            _data.get_deleter().locked = _size * sizeof(double);
+    }
+
+    void Arena::unlock() {
+        if (!_data.get_deleter().locked) return;
+        Scheduling::unlock(_data.get(), _data.get_deleter().locked);
+        _data.get_deleter().locked = 0;
+    }
+
+    std::span<double> Arena::take(std::size_t count, bool align) {
+        const std::size_t _start = align ? aligned(_used) : _used;
+        if (_start + count > _size) return {};
+        _used = _start + count;
+        return { _data.get() + _start, count };
+    }
+}
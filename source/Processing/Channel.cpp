@@ -1,10 +1,9 @@
 #include "Processing/Channel.hpp"
-#include "Controller.hpp"
 
 namespace Mixijo {
     
 
-    void Channel::getSettings(std::ofstream& file) {
+    void Channel::getSettings(std::ostream& file) {
         file << "gain=" << gain << ",limiter=" << (enableLimiter ? 1 : 0);
     }
 
@@ -13,21 +12,19 @@ namespace Mixijo {
         if (name == "limiter") enableLimiter = val;
     }
 
-    void Channel::addMidiLink(std::string_view name, int id) {
-        if (name == "gain") midiLinks[id] = Gain;
+    void Channel::set(MidiLink link, double value) {
+        switch (link) {
+        case Gain: gain = value; break;
+        case Meter: break; // Output only
+        }
     }
 
-    void Channel::handleMidi(int id, int value) {
-        if (!midiLinks.contains(id)) return;
-        else switch (midiLinks.at(id)) {
-            case Gain: gain = std::pow(Controller::maxLin * value / 127., 4); break;
-        }
+    void Channel::prepare(double sampleRate, double ms) {
+        smoothing = 1 - std::exp(-1.0 / ((ms / 1000.0) * sampleRate));
     }
 
     void Channel::add(int endpoint) {
         endpoints.push_back(endpoint);
-        values.resize(endpoints.size());
-        peaks.resize(endpoints.size());
         limiter.delayedBuffer.emplace_back();
         for (auto& _buffer : limiter.delayedBuffer)
             _buffer.resize(144);
@@ -35,42 +32,81 @@ namespace Mixijo {
 
     void Channel::remove(int endpoint) {
         endpoints.erase(std::remove(endpoints.begin(), endpoints.end(), endpoint), endpoints.end());
-        values.resize(endpoints.size());
-        peaks.resize(endpoints.size());
+    }
+
+    void Channel::clearEndpoints() {
+        endpoints.clear();
+        limiter.delayedBuffer.clear();
+        limiter.delayedAccessor = 0;
     }
 
     void Channel::process() {
+        const double _gain = nextGain();
         for (std::size_t i = 0; i < values.size(); ++i) {
-            if (enableLimiter) values[i] = limiter.process(values[i], i) * gain;
-            else values[i] *= gain;
+            if (enableLimiter) values[i] = limiter.process(values[i], i) * _gain;
+            else values[i] *= _gain;
             const double _abs = std::abs(values[i]);
             peaks[i] = std::max(_abs, peaks[i]);
         }
     }
 
-    void InputChannel::generate(Buffer<double>::Frame& frame) {
-        idle = true;
-        for (std::size_t i = 0; int _endpoint : endpoints) {
-            values[i] = frame[_endpoint] * gain;
-            peaks[i] = std::max(std::abs(values[i]), peaks[i]);
-            idle &= values[i] == 0;
-            ++i;
+    // Kernels are picked once per configuration, so the widths are compile time constants
+    // in the hot loops, which the compiler fully unrolls. Width 0 is the generic kernel.
+    template<class Kernel>
+    static Kernel pick(std::size_t width, Kernel one, Kernel two, Kernel six, Kernel eight, Kernel any) {
+        switch (width) {
+        case 1: return one;
+        case 2: return two;
+        case 6: return six;
+        case 8: return eight;
+        default: return any;
+        }
+    }
+
+    void InputChannel::specialize() {
+        _generate = pick<Generate>(endpoints.size(), &generateWidth<1>, &generateWidth<2>, &generateWidth<6>, &generateWidth<8>, &generateWidth<0>);
+    }
+
+    template<std::size_t Width>
+    void InputChannel::generateWidth(InputChannel& self, Buffer<double>::Frame& frame) {
+        const std::size_t _width = Width ? Width : self.endpoints.size();
+        const int* _endpoints = self.endpoints.data();
+        double* _values = self.values.data();
+        double* _peaks = self.peaks.data();
+        const double _gain = self.nextGain();
+        bool _idle = true;
+        for (std::size_t i = 0; i < _width; ++i) {
+            _values[i] = frame[_endpoints[i]] * _gain;
+            _peaks[i] = std::max(std::abs(_values[i]), _peaks[i]);
+            _idle &= _values[i] == 0;
         }
+        self.idle = _idle;
     }
 
-    void OutputChannel::receive(const std::vector<double>& in, double level) {
-        const auto _valSize = values.size();
-        const auto _inSize = in.size();
-        if (_valSize == 0 || _inSize == 0) return;
-        if (_valSize == _inSize) {
-            for (std::size_t i = 0; i < _valSize; ++i)
-                values[i] += in[i] * level;
-        } else if (_valSize > _inSize) {
-            for (std::size_t i = 0; i < _valSize; ++i)
-                values[i] += in[i % _inSize] * level;
+    void OutputChannel::specialize() {
+        _receive = pick<Receive>(endpoints.size(), &receiveWidth<1>, &receiveWidth<2>, &receiveWidth<6>, &receiveWidth<8>, &receiveWidth<0>);
+        _generate = pick<Generate>(endpoints.size(), &generateWidth<1>, &generateWidth<2>, &generateWidth<6>, &generateWidth<8>, &generateWidth<0>);
+    }
+
+    template<std::size_t Width>
+    void OutputChannel::receiveWidth(OutputChannel& self, std::span<const double> in, double level) {
+        const std::size_t _width = Width ? Width : self.values.size();
+        const std::size_t _inSize = in.size();
+        double* _values = self.values.data();
+        if (_width == 0 || _inSize == 0) return;
+        if (_inSize == _width) {
+            for (std::size_t i = 0; i < _width; ++i)
+                _values[i] += in[i] * level;
+        } else if (_inSize == 1) { // Mono input, same as wrapping around, without the modulo
+            const double _value = in[0] * level;
+            for (std::size_t i = 0; i < _width; ++i)
+                _values[i] += _value;
+        } else if (_width > _inSize) {
+            for (std::size_t i = 0; i < _width; ++i)
+                _values[i] += in[i % _inSize] * level;
         } else {
             for (std::size_t i = 0; i < _inSize; ++i)
-                values[i % _valSize] += in[i] * level;
+                _values[i % _width] += in[i] * level;
         }
     }
 
@@ -78,12 +114,22 @@ namespace Mixijo {
         for (auto& _v : values) _v = 0;
     }
 
-    void OutputChannel::generate(Buffer<double>::Frame& frame) {
-        for (std::size_t i = 0; int _endpoint : endpoints) {
-            frame[_endpoint] += values[i] * gain;
-            peaks[i] = std::max(std::abs(values[i] * gain), peaks[i]);
-            values[i] = 0;
-            ++i;
+    template<std::size_t Width>
+    void OutputChannel::generateWidth(OutputChannel& self, Buffer<double>::Frame& frame) {
+        const std::size_t _width = Width ? Width : self.endpoints.size();
+        const int* _endpoints = self.endpoints.data();
+        double* _values = self.values.data();
+        double* _peaks = self.peaks.data();
+        const double _gain = self.nextGain();
+        for (std::size_t i = 0; i < _width; ++i) {
+            frame[_endpoints[i]] += _values[i] * _gain;
+            _peaks[i] = std::max(std::abs(_values[i] * _gain), _peaks[i]);
+            _values[i] = 0;
         }
     }
+
+    // The generic kernels are the defaults of every channel
+    template void InputChannel::generateWidth<0>(InputChannel&, Buffer<double>::Frame&);
+    template void OutputChannel::receiveWidth<0>(OutputChannel&, std::span<const double>, double);
+    template void OutputChannel::generateWidth<0>(OutputChannel&, Buffer<double>::Frame&);
 }
\ No newline at end of file
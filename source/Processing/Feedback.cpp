@@ -0,0 +1,134 @@
+#include "Processing/Feedback.hpp"
+#include "Processing/Processor.hpp"
+#include "Controller.hpp"
+#include "Trace.hpp"
+
+namespace Mixijo {
+
+    Feedback::Feedback(Processor& processor)
+        : _processor(processor)
+    {}
+
+    Feedback::~Feedback() { stop(); }
+
+    void Feedback::start() {
+        if (_running) return;
+        _running = true;
+        _thread = std::thread{ [this] { run(); } };
+    }
+
+    void Feedback::stop() {
+        _running = false;
+        if (_thread.joinable()) _thread.join();
+    }
+
+    void Feedback::forward(const Midijo::Event& e) {
+        if (!_thru.push(e)) ++_dropped;
+    }
+
+    void Feedback::run() {
+        MIXIJO_TRACE_THREAD("feedback");
+        auto _next = std::chrono::steady_clock::now();
+        std::size_t _reported = 0;
+        while (_running) {
+            Scheduling::apply(Scheduling::Feedback);
+            {
+                std::scoped_lock _{ _processor.midiLock }; // Also taken by the midi-in handler, keep it short
+                collect();
+            }
+
+            {
+                std::scoped_lock _{ _processor.midiOutLock };
+                const bool _opened = _processor.midiout.Information().state == Midijo::Opened;
+                for (Midijo::Event _event; _thru.pop(_event);)
+                    if (_opened) _processor.midiout.Message(_event);
+
+                const auto _now = std::chrono::steady_clock::now();
+                if (_now >= _next) {
+                    if (_opened) flush();
+                    const auto _period = std::chrono::duration<double>{ 1. / std::max(rate.load(std::memory_order_relaxed), 1.) };
+                    _next = std::max(_next + std::chrono::duration_cast<std::chrono::steady_clock::duration>(_period), _now);
+                }
+            }
+
+            if (const std::size_t _count = _dropped; _count != _reported) {
+                _reported = _count;
+                Controller::logger.errline("Midi-out can't keep up, dropped ", _count, " midi events in total");
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    void Feedback::rebuild() {
+        _generation = _processor.generation;
+        _targets.clear();
+        _pending.assign(_processor.midiMappings.size(), std::nullopt);
+        _sent.assign(_processor.midiMappings.size(), -1);
+        _mappings.clear();
+        for (std::size_t i = 0; i < _processor.midiMappings.size(); ++i) {
+            auto& _mapping = _processor.midiMappings[i];
+            _mappings.push_back({ _mapping.source.type, _mapping.source.number, _mapping.source.lsb, _mapping.touched });
+            if (!_mapping.feedback) continue;
+            auto& _target = _mapping.target;
+            _targets[key(_target.input, _target.channel, _target.link)].push_back(i);
+        }
+    }
+
+    void Feedback::collect() {
+        if (_generation != _processor.generation) rebuild();
+        for (std::size_t i = 0; i < _mappings.size(); ++i) // Only the touched time changes within a generation
+            _mappings[i].touched = _processor.midiMappings[i].touched;
+        for (Processor::ParameterChange _change; _processor.feedbackChanges.pop(_change);) {
+            if (_change.generation != _generation) continue;
+            auto _it = _targets.find(key(_change.input, _change.channel, _change.link));
+            if (_it == _targets.end()) continue;
+            for (std::size_t _index : _it->second) _pending[_index] = _change.value;
+        }
+    }
+
+    void Feedback::flush() {
+        MIXIJO_TRACE("Feedback::flush");
+        const auto _now = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < _pending.size(); ++i) {
+            if (!_pending[i].has_value()) continue;
+            // Don't fight a fader that is being moved on the controller
+            if (_now - _mappings[i].touched < std::chrono::milliseconds(250)) continue;
+            const double _lin = std::pow(_pending[i].value(), 0.25) / Controller::maxLin;
+            const int _value = static_cast<int>(std::round(std::clamp(_lin, 0., 1.) * 16383));
+            _pending[i].reset();
+            if (_value == _sent[i]) continue;
+            send(i, _value);
+            _sent[i] = _value;
+        }
+    }
+
+    void Feedback::send(std::size_t mapping, int value) {
+        auto& _source = _mappings[mapping];
+        auto& _out = _processor.midiout;
+        switch (_source.type) {
+        case Processor::MidiSource::CC:
+            _out.Message(Midijo::CC{ _source.number, (value * 127 + 8191) / 16383 });
+            break;
+        case Processor::MidiSource::CC14:
+            _out.Message(Midijo::CC{ _source.number, value >> 7 });
+            _out.Message(Midijo::CC{ _source.lsb, value & 127 });
+            break;
+        case Processor::MidiSource::NRPN:
+            _out.Message(Midijo::CC{ 99, _source.number >> 7 });
+            _out.Message(Midijo::CC{ 98, _source.number & 127 });
+            _out.Message(Midijo::CC{ 6, value >> 7 });
+            _out.Message(Midijo::CC{ 38, value & 127 });
+            break;
+        case Processor::MidiSource::PitchBend:
+            _out.Message(Midijo::PitchWheel{ value, _source.number });
+            break;
+        }
+    }
+
+    std::uint64_t Feedback::key(bool input, int channel, int link) {
+        return (static_cast<std::uint64_t>(input) << 48)
+            | (static_cast<std::uint64_t>(link) << 32)
+            | static_cast<std::uint32_t>(channel);
+    }
+}
@@ -0,0 +1,175 @@
+#include "Processing/Graph.hpp"
+
+namespace Mixijo {
+
+    Graph::Graph(const Graph& other, const Scene& parameters)
+        : fadeFrom(other.fadeFrom), fadeTo(other.fadeTo)
+    {
+        const auto _copy = [](Channel& to, const Channel& from, double gain, bool limiter) {
+            to.name = from.name;
+            for (int _endpoint : from.endpoints) to.add(_endpoint);
+            to.smoothing = from.smoothing;
+            to.gain = to.smoothedGain = gain;
+            to.enableLimiter = limiter;
+        };
+
+        inputs.reserve(other.inputs.size());
+        outputs.reserve(other.outputs.size());
+        for (std::size_t i = 0; i < other.inputs.size(); ++i)
+            _copy(inputs.emplace_back(), other.inputs[i], parameters.inputGains[i], parameters.inputLimiters[i]);
+        for (std::size_t i = 0; i < other.outputs.size(); ++i)
+            _copy(outputs.emplace_back(), other.outputs[i], parameters.outputGains[i], parameters.outputLimiters[i]);
+
+        layout();
+        for (std::size_t i = 0; auto& _input : inputs)
+            std::copy_n(parameters.levels.begin() + i++ * outputs.size(), outputs.size(), _input.output_levels.begin());
+    }
+
+    void Graph::adopt(Graph& previous) {
+        if (!startsFade) {
+            fadeLength = previous.fadeLength;
+            fadePosition = previous.fadePosition;
+        }
+
+        const auto _carry = [](Channel& to, Channel& from) {
+            if (to.endpoints != from.endpoints) return; // Another channel now, it starts over
+            if (!to.jump) to.smoothedGain = from.smoothedGain;
+            to.publishedGain = from.publishedGain;
+            to.meter = from.meter;
+            std::copy(from.held.begin(), from.held.end(), to.held.begin());
+            to.limiter.compressor = from.limiter.compressor;
+            to.limiter.delayedAccessor = from.limiter.delayedAccessor;
+            for (std::size_t i = 0; i < to.limiter.delayedBuffer.size(); ++i)
+                std::ranges::copy(from.limiter.delayedBuffer[i], to.limiter.delayedBuffer[i].begin());
+        };
+
+        for (std::size_t i = 0; i < std::min(inputs.size(), previous.inputs.size()); ++i) _carry(inputs[i], previous.inputs[i]);
+        for (std::size_t i = 0; i < std::min(outputs.size(), previous.outputs.size()); ++i) _carry(outputs[i], previous.outputs[i]);
+    }
+
+    void Graph::layout(bool specialize) {
+        const auto _laidOut = [&] {
+            for (auto& _input : inputs)
+                if (_input.values.size() != _input.endpoints.size() || _input.output_levels.size() != outputs.size()) return false;
+            for (auto& _output : outputs)
+                if (_output.values.size() != _output.endpoints.size()) return false;
+            return true;
+        };
+        if (_laidOut()) return;
+
+        std::size_t _samples = 0;
+        for (auto& _input : inputs) _samples += _input.endpoints.size();
+        for (auto& _output : outputs) _samples += _output.endpoints.size();
+        const std::size_t _routes = inputs.size() * outputs.size();
+
+        Arena _next{ 3 * Arena::aligned(_samples) + _routes };
+        _next.lock(); // Zeroed, so already faulted in, locking keeps it that way
+        const std::span<double> _values = _next.take(_samples, true);
+        const std::span<double> _peaks = _next.take(_samples, true);
+        const std::span<double> _held = _next.take(_samples, true);
+        const std::span<double> _levels = _next.take(_routes, true);
+
+        std::size_t _offset = 0;
+        const auto _place = [&](Channel& channel) {
+            const std::size_t _count = channel.endpoints.size();
+            channel.values = _values.subspan(_offset, _count);
+            channel.peaks = _peaks.subspan(_offset, _count);
+            channel.held = _held.subspan(_offset, _count);
+            _offset += _count;
+        };
+
+        for (std::size_t i = 0; auto& _input : inputs) {
+            _place(_input);
+            if (specialize) _input.specialize();
+            const std::span<double> _row = _levels.subspan(i++ * outputs.size(), outputs.size());
+            std::copy_n(_input.output_levels.begin(), std::min(_row.size(), _input.output_levels.size()), _row.begin());
+            _input.output_levels = _row;
+        }
+        for (auto& _output : outputs) {
+            _place(_output);
+            if (specialize) _output.specialize();
+        }
+
+        _arena = std::move(_next); // The old routing was still read above
+        _allPeaks = _peaks;
+        _allHeld = _held;
+    }
+
+    void Graph::lockArena(bool locked) {
+        // The audio thread only uses the spans, the arena itself is only touched by layout
+        if (locked) _arena.lock();
+        else _arena.unlock();
+    }
+
+    void Graph::capture(Scene& scene) const {
+        scene.inputGains.resize(inputs.size());
+        scene.inputLimiters.resize(inputs.size());
+        scene.outputGains.resize(outputs.size());
+        scene.outputLimiters.resize(outputs.size());
+        scene.levels.resize(inputs.size() * outputs.size());
+        for (std::size_t i = 0; i < inputs.size(); ++i) {
+            scene.inputGains[i] = inputs[i].gain;
+            scene.inputLimiters[i] = inputs[i].enableLimiter;
+            std::copy_n(inputs[i].output_levels.begin(), outputs.size(), scene.levels.begin() + i * outputs.size());
+        }
+        for (std::size_t i = 0; i < outputs.size(); ++i) {
+            scene.outputGains[i] = outputs[i].gain;
+            scene.outputLimiters[i] = outputs[i].enableLimiter;
+        }
+    }
+
+    void Graph::fade(std::size_t frames) {
+        if (fadePosition >= fadeLength) return;
+        if (fadeTo.inputGains.size() != inputs.size() || fadeTo.outputGains.size() != outputs.size()
+            || fadeFrom.inputGains.size() != inputs.size() || fadeFrom.outputGains.size() != outputs.size()) {
+            fadeLength = 0; // Channels changed during the crossfade
+            return;
+        }
+
+        fadePosition = std::min(fadePosition + frames, fadeLength);
+        const double _t = static_cast<double>(fadePosition) / fadeLength;
+        const auto _lerp = [&](double from, double to) { return from + (to - from) * _t; };
+        for (std::size_t i = 0; i < inputs.size(); ++i) {
+            inputs[i].gain = _lerp(fadeFrom.inputGains[i], fadeTo.inputGains[i]);
+            for (std::size_t j = 0; j < outputs.size(); ++j) {
+                const std::size_t _index = i * outputs.size() + j;
+                inputs[i].output_levels[j] = _lerp(fadeFrom.levels[_index], fadeTo.levels[_index]);
+            }
+        }
+        for (std::size_t i = 0; i < outputs.size(); ++i)
+            outputs[i].gain = _lerp(fadeFrom.outputGains[i], fadeTo.outputGains[i]);
+    }
+
+    void Graph::begin(Buffer<double>& out, Analyzer* analyzer) {
+        // Only the channel with an opened analyzer is tapped
+        _analyzer = analyzer;
+        _tap = nullptr;
+        if (const Analyzer::Target _target = analyzer ? analyzer->target() : Analyzer::Target{ false, -1 }; _target.channel >= 0) {
+            const auto _index = static_cast<std::size_t>(_target.channel);
+            _tapInput = _target.input;
+            if (_tapInput && _index < inputs.size()) _tap = &inputs[_index];
+            else if (!_tapInput && _index < outputs.size()) _tap = &outputs[_index];
+        }
+        for (std::size_t i = 0; i < out.Channels(); ++i)
+            std::memset(out.data()[i], 0, out.Frames() * sizeof(double));
+        std::ranges::fill(_allPeaks, 0);
+    }
+
+    void Graph::frame(Buffer<double>::Frame& in, Buffer<double>::Frame& out) {
+        for (auto& _input : inputs) {
+            _input.generate(in);
+            if (_input.idle) continue;
+            for (std::size_t j = 0; double _level : _input.output_levels)
+                outputs[j++].receive(_input.values, _level);
+        }
+        // Outputs clear their values when generating, so tap them before, with the gain they'll get
+        if (_tap) _analyzer->tap(_tap->values, _tapInput ? 1. : _tap->smoothedGain);
+        for (auto& _output : outputs) _output.generate(out);
+        for (auto& _endpoint : out) _endpoint = std::clamp(_endpoint, -1., 1.);
+    }
+
+    void Graph::end() {
+        // Held until the gui reads them, the meter feedback keeps its own, see Processor::publishFeedback
+        for (std::size_t i = 0; i < _allPeaks.size(); ++i) _allHeld[i] = std::max(_allHeld[i], _allPeaks[i]);
+    }
+}
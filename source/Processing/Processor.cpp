@@ -1,54 +1,77 @@
 #include "Processing/Processor.hpp"
 #include "Controller.hpp"
+#include "Trace.hpp"
 
 namespace Mixijo {
 
     InputChannel& Processor::Inputs::add() {
-        auto& _channel = _data.emplace_back();
-        _channel.output_levels.resize(self.outputs.size());
+        auto& _channel = data().emplace_back();
+        _channel.prepare(Controller::sampleRate);
         return _channel;
     }
 
     void Processor::Inputs::remove(int index) {
-        _data.erase(_data.begin() + index);
+        data().erase(data().begin() + index);
     }
 
     OutputChannel& Processor::Outputs::add() {
-        auto& _channel = _data.emplace_back();
-        for (auto& _input : self.inputs)
-            _input.output_levels.resize(_data.size());
+        auto& _channel = data().emplace_back();
+        _channel.prepare(Controller::sampleRate);
         return _channel;
     }
 
     void Processor::Outputs::remove(int index) {
-        _data.erase(_data.begin() + index);
-        for (auto& _input : self.inputs)
-            _input.output_levels.erase(_input.output_levels.begin() + index);
+        data().erase(data().begin() + index);
+        for (auto& _input : self.inputs) { // Drop the column from the routing, layout keeps the rest
+            auto& _levels = _input.output_levels;
+            if (_levels.size() <= static_cast<std::size_t>(index)) continue;
+            std::shift_left(_levels.begin() + index, _levels.end(), 1);
+            _levels = _levels.first(_levels.size() - 1);
+        }
     }
 
     Processor::Processor() {
+        // Midi-in is opened async, so these run on the midi thread the moment an event
+        // arrives, and are stamped against the audio clock right there
         midiin.Callback([&](const Midijo::Event& e) {
-            if (midiout.Information().state == Midijo::Opened)
-                midiout.Message(e);
+            feedback.forward(e);
         });
         midiin.Callback([&](const Midijo::CC& e) {
-            for (auto& _in : inputs) _in.handleMidi(e.Number(), e.Value());
-            for (auto& _out : outputs) _out.handleMidi(e.Number(), e.Value());
+            handleMidi(e.Number(), e.Value());
+        });
+        midiin.Callback([&](const Midijo::PitchWheel& e) {
+            handlePitchBend(e.Channel(), e.Value());
         });
     }
 
     bool Processor::init() {
         deinit();
-        bool _success = true;
-        if (initAudio() != Audijo::NoError) _success = false;
-        if (initMidi() != Midijo::NoError) _success = false;
-        return true;
+
+        // Enumerating devices is slow, so open the midi devices while the audio device opens
+        Midijo::Error _midi = Midijo::NoError;
+        std::chrono::steady_clock::duration _midiTime{};
+        std::thread _midiThread{ [&] {
+            const auto _start = std::chrono::steady_clock::now();
+            _midi = initMidi();
+            _midiTime = std::chrono::steady_clock::now() - _start;
+        } };
+
+        const auto _start = std::chrono::steady_clock::now();
+        const Audijo::Error _audio = initAudio();
+        const auto _audioTime = std::chrono::steady_clock::now() - _start;
+        _midiThread.join();
+
+        feedback.start();
+        Controller::logline("Opened audio device in ", std::chrono::duration_cast<std::chrono::milliseconds>(_audioTime).count(),
+            "ms, midi devices in ", std::chrono::duration_cast<std::chrono::milliseconds>(_midiTime).count(), "ms");
+        return _audio == Audijo::NoError && _midi == Midijo::NoError;
     }
 
     Audijo::Error Processor::initAudio() {
         Callback(callback);
         UserData(*this);
-        auto& devices = Devices(true);
+        auto& devices = Devices(_rescanAudio);
+        _rescanAudio = false;
         for (auto& _device : devices) {
             if (_device.name == Controller::audioDevice) {
                 Controller::logline("Opening device (", _device.name, ")");
@@ -70,6 +93,7 @@ namespace Mixijo {
                     .sampleRate = Controller::sampleRate,
                 });
                 if (_res == Audijo::NoError) _res = Start();
+                indexEndpoints();
                 if (_res != Audijo::NoError) {
                     switch (_res) {
                     case Audijo::InvalidBufferSize: Controller::errline("Invalid buffer size! (", Controller::bufferSize, ")"); break;
@@ -83,17 +107,18 @@ namespace Mixijo {
         }
         Controller::errline("No audio device found with the name (", Controller::audioDevice, ")");
         Controller::logline("available audio devices:");
-        for (auto& device : Devices()) {
+        for (auto& device : devices) {
             Controller::logline("  " + device.name);
         }
+        return Audijo::NotPresent;
     }
 
     Midijo::Error Processor::initMidi() {
-        auto& _indevices = midiin.Devices(true);
+        auto& _indevices = midiin.Devices(_rescanMidi);
         bool _found = false;
         for (auto& _device : _indevices) {
             if (_device.name == Controller::midiinDevice) {
-                auto _res = midiin.Open({ .device = _device.id, .async = false });
+                auto _res = midiin.Open({ .device = _device.id, .async = true });
                 _found = true;
                 if (_res != Midijo::NoError) {
                     switch (_res) {
@@ -108,12 +133,13 @@ namespace Mixijo {
             if (Controller::midiinDevice != "") 
                 Controller::errline("No midi-in device found with the name (", Controller::midiinDevice, ")");
             Controller::logline("available midi-in devices:");
-            for (auto& device : midiin.Devices()) {
+            for (auto& device : _indevices) {
                 Controller::logline("  " + device.name);
             }
         }
         _found = false;
-        auto& _outdevices = midiout.Devices(true);
+        auto& _outdevices = midiout.Devices(_rescanMidi);
+        _rescanMidi = false;
         for (auto& _device : _outdevices) {
             if (_device.name == Controller::midioutDevice) {
                 auto _res = midiout.Open({ .device = _device.id, .async = false });
@@ -131,41 +157,338 @@ namespace Mixijo {
             if (Controller::midioutDevice != "")
                 Controller::errline("No midi-out device found with the name (", Controller::midioutDevice, ")");
             Controller::logline("available midi-out devices:");
-            for (auto& device : midiout.Devices()) {
+            for (auto& device : _outdevices) {
                 Controller::logline("  " + device.name);
             }
         }
         return Midijo::NoError;
     }
 
+    Midijo::Error Processor::reopenMidi() {
+        deinitMidi();
+        _rescanMidi = true; // Only reopened when the device changed, which may be a new device
+        Midijo::Error _res = initMidi();
+        feedback.start();
+        return _res;
+    }
+
     void Processor::deinit() {
+        analyzer.close();
+        deinitMidi();
+        Close();
+        indexEndpoints();
+    }
+
+    void Processor::deinitMidi() {
+        feedback.stop();
         midiin.Close();
+        std::scoped_lock _{ midiOutLock };
         midiout.Close();
-        Close();
     }
 
     void Processor::callback(Buffer<double>& in, Buffer<double>& out, CallbackInfo info, Processor& self) {
-        std::scoped_lock _{ self.lock };
+        self.process(in, out);
+    }
+
+    void Processor::process(Buffer<double>& in, Buffer<double>& out) {
+        MIXIJO_REALTIME();
+        {
+            // Claims a trace buffer and applies the scheduling only the first time, or when the settings changed
+            MIXIJO_REALTIME_ALLOW();
+            MIXIJO_TRACE_THREAD("audio");
+            Scheduling::apply(Scheduling::Audio);
+        }
+        MIXIJO_TRACE("Processor::process");
         auto _frames = out.Frames();
-        for (std::size_t i = 0; i < out.Channels(); ++i)
-            std::memset(out.data()[i], 0, _frames * sizeof(double));
-        for (std::size_t i = 0; i < _frames; ++i) {
-            auto _in_frame = in[i], _out_frame = out[i];
-            for (auto& _input : self.inputs) {
-                _input.generate(_in_frame);
-                if (_input.idle) continue;
-                for (std::size_t j = 0; double _level : _input.output_levels)
-                    self.outputs[j++].receive(_input.values, _level);
+        publishClock(_frames);
+
+        // Only taken by the controller when this thread wasn't processing for a while, see wait
+        if (_processing.exchange(true, std::memory_order_acquire)) {
+            for (std::size_t i = 0; i < out.Channels(); ++i)
+                std::memset(out.data()[i], 0, _frames * sizeof(double));
+            _sampleTime += _frames;
+            return;
+        }
+
+        adopt();
+        _live->process(in, out, &analyzer, [&](std::size_t i) { applyChanges(_sampleTime + i); });
+        serveCapture();
+        {
+            MIXIJO_TRACE("Processor::publishFeedback");
+            publishFeedback(_frames);
+        }
+        _processing.store(false, std::memory_order_release);
+        _sampleTime += _frames;
+    }
+
+    void Processor::adopt() {
+        if (Graph* _adopted = _next.load(std::memory_order_acquire)) {
+            _adopted->adopt(*_live);
+            _live = _adopted;
+            _next.store(nullptr, std::memory_order_release); // The controller frees the previous graph now
+        }
+    }
+
+    void Processor::serveCapture() {
+        if (Scene* _scene = _capture.load(std::memory_order_acquire)) {
+            _live->capture(*_scene); // Sized by the controller, so it doesn't allocate
+            _capture.store(nullptr, std::memory_order_release);
+        }
+    }
+
+    bool Processor::running() const {
+        if (_clockSequence.load(std::memory_order_acquire) == 0) return false;
+        const auto _now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        return _now - _clockNanos.load(std::memory_order_relaxed) < 100'000'000; // A block in the last 100ms
+    }
+
+    void Processor::wait(const auto& request) {
+        while (request.load(std::memory_order_acquire)) {
+            // Without callbacks nothing else processes the graph, so serve the request in place of the audio thread
+            if (!running() && !_processing.exchange(true, std::memory_order_acquire)) {
+                adopt();
+                serveCapture();
+                _processing.store(false, std::memory_order_release);
+                return;
             }
-            for (auto& _output : self.outputs) _output.generate(_out_frame);
-            for (auto& _endpoint : _out_frame) _endpoint = std::clamp(_endpoint, -1., 1.);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
         }
     }
 
+    void Processor::publish(std::unique_ptr<Graph> next) {
+        _next.store(next.get(), std::memory_order_release);
+        wait(_next);
+        _graph = std::move(next); // The audio thread moved on, this frees the previous graph
+        _view = _graph.get();
+    }
+
+    void Processor::capture(Scene& scene) {
+        std::scoped_lock _{ lock };
+        snapshot(scene);
+    }
+
+    void Processor::snapshot(Scene& scene) {
+        scene.inputGains.resize(_graph->inputs.size());
+        scene.inputLimiters.resize(_graph->inputs.size());
+        scene.outputGains.resize(_graph->outputs.size());
+        scene.outputLimiters.resize(_graph->outputs.size());
+        scene.levels.resize(_graph->inputs.size() * _graph->outputs.size());
+        _capture.store(&scene, std::memory_order_release);
+        wait(_capture);
+    }
+
     int Processor::find_endpoint(std::string_view name, bool in) {
-        if (Information().state == Audijo::StreamState::Closed) return -1;
-        for (auto& _channel : endpoints())
-            if (_channel.input == in && _channel.name == name) return _channel.id;
-        return -1;
+        auto& _endpoints = in ? _inputEndpoints : _outputEndpoints;
+        auto _it = _endpoints.find(name);
+        return _it == _endpoints.end() ? -1 : _it->second;
+    }
+
+    void Processor::indexEndpoints() {
+        _inputEndpoints.clear();
+        _outputEndpoints.clear();
+        if (Information().state == Audijo::StreamState::Closed) return;
+        for (auto& _channel : endpoints()) // First endpoint wins when names are duplicated
+            (_channel.input ? _inputEndpoints : _outputEndpoints).emplace(_channel.name, _channel.id);
+    }
+
+    void Processor::addMidiLink(bool input, int channel, std::string_view name, MidiSource source, bool feedback) {
+        std::scoped_lock _{ midiLock };
+        MidiTarget _target{ input, channel, Channel::Gain };
+        if (name == "gain") _target.link = Channel::Gain;
+        else if (name == "meter") _target.link = Channel::Meter;
+        else return;
+
+        if (_target.link == Channel::Meter) { // Output only, so not in the dispatch tables
+            midiMappings.push_back({ source, _target, true });
+            feedbackMeters = true;
+            return;
+        }
+
+        const auto _valid = [](int cc) { return cc >= 0 && cc < 128; };
+        const std::size_t _index = midiMappings.size();
+        switch (source.type) {
+        case MidiSource::CC:
+            if (!_valid(source.number)) return;
+            midiMap[source.number].push_back(_index);
+            break;
+        case MidiSource::CC14:
+            if (!_valid(source.number) || !_valid(source.lsb)) return;
+            midiMap[source.number].push_back(_index);
+            midiMap[source.lsb].push_back(_index);
+            break;
+        case MidiSource::NRPN:
+            if (source.number < 0 || source.number >= 16384) return;
+            nrpnMap[source.number].push_back(_index);
+            break;
+        case MidiSource::PitchBend:
+            pitchBendMap.push_back(_index);
+            break;
+        }
+        midiMappings.push_back({ source, _target, feedback });
+        if (feedback) feedbackGains = true;
+    }
+
+    void Processor::clearMidiLinks() {
+        std::scoped_lock _{ midiLock };
+        feedbackGains = false;
+        feedbackMeters = false;
+        midiMappings.clear();
+        for (auto& _mappings : midiMap) _mappings.clear();
+        nrpnMap.clear();
+        pitchBendMap.clear();
+        ++generation;
+    }
+
+    void Processor::handleMidi(int cc, int value) {
+        MIXIJO_TRACE("Processor::handleMidi");
+        if (cc < 0 || cc >= static_cast<int>(midiMap.size())) return;
+        std::scoped_lock _{ midiLock };
+        const std::uint64_t _time = timestamp();
+
+        switch (cc) { // Data entry only applies to a selected NRPN, RPNs and the null parameter are ignored
+        case 99: _nrpnParameter = (value << 7) | (_nrpnParameter & 127), _nrpnSelected = true; break;
+        case 98: _nrpnParameter = (_nrpnParameter & ~127) | value, _nrpnSelected = true; break;
+        case 101: case 100: _nrpnSelected = false; break;
+        case 6: case 38:
+            if (!_nrpnSelected || _nrpnParameter == 16383) break;
+            if (cc == 6) _nrpnMsb = value;
+            if (auto _it = nrpnMap.find(_nrpnParameter); _it != nrpnMap.end())
+                for (std::size_t _index : _it->second)
+                    post(midiMappings[_index], (_nrpnMsb << 7) | (cc == 38 ? value : 0), _time);
+            break;
+        }
+
+        for (std::size_t _index : midiMap[cc]) {
+            auto& _mapping = midiMappings[_index];
+            if (_mapping.source.type == MidiSource::CC) {
+                post(_mapping, value * 16383 / 127, _time);
+            } else if (cc == _mapping.source.number) { // 14-bit msb
+                _mapping.msb = value;
+                post(_mapping, value << 7, _time);
+            } else { // 14-bit lsb
+                post(_mapping, (_mapping.msb << 7) | value, _time);
+            }
+        }
+    }
+
+    void Processor::handlePitchBend(int channel, int value) {
+        MIXIJO_TRACE("Processor::handlePitchBend");
+        std::scoped_lock _{ midiLock };
+        const std::uint64_t _time = timestamp();
+        for (std::size_t _index : pitchBendMap) {
+            auto& _mapping = midiMappings[_index];
+            if (_mapping.source.number == channel) post(_mapping, value, _time);
+        }
+    }
+
+    void Processor::post(MidiMapping& mapping, int value, std::uint64_t time) {
+        mapping.touched = std::chrono::steady_clock::now();
+        double _value = 0;
+        switch (mapping.target.link) {
+        case Channel::Gain: _value = controllerGain(value); break;
+        }
+        if (!changes.push({ time, generation, mapping.target.input, mapping.target.channel, mapping.target.link, _value }))
+            Controller::logger.errline("Parameter queue is full, dropped a midi change for channel ", mapping.target.channel);
+    }
+
+    void Processor::publishFeedback(std::size_t frames) {
+        const bool _gains = feedbackGains.load(std::memory_order_relaxed);
+        const bool _meters = feedbackMeters.load(std::memory_order_relaxed);
+        if (!_gains && !_meters) return;
+
+        bool _sendMeters = false;
+        if (_meters && (_meterSamples += frames) >= Controller::sampleRate / std::max(feedback.rate.load(std::memory_order_relaxed), 1.))
+            _sendMeters = true, _meterSamples = 0;
+
+        const auto _publish = [&](Channel& channel, bool input, int index) {
+            if (_gains && channel.gain != channel.publishedGain
+                && feedbackChanges.push({ _sampleTime, generation, input, index, Channel::Gain, channel.gain }))
+                channel.publishedGain = channel.gain;
+            if (_meters) { // Its own peak since the last send, the gui resets the held peaks whenever it likes
+                for (double _peak : channel.peaks) channel.meter = std::max(channel.meter, _peak);
+                if (_sendMeters && feedbackChanges.push({ _sampleTime, generation, input, index, Channel::Meter, channel.meter }))
+                    channel.meter = 0;
+            }
+        };
+
+        for (int i = 0; auto& _input : _live->inputs) _publish(_input, true, i++);
+        for (int i = 0; auto& _output : _live->outputs) _publish(_output, false, i++);
+    }
+
+    bool Processor::recall(const Scene& scene, double ms) {
+        std::scoped_lock _{ lock };
+        if (scene.inputGains.size() != _graph->inputs.size() || scene.outputGains.size() != _graph->outputs.size()) return false;
+        Scene _from;
+        snapshot(_from);
+        auto _next = std::make_unique<Graph>(*_graph, _from);
+        for (std::size_t i = 0; i < _next->inputs.size(); ++i) _next->inputs[i].enableLimiter = scene.inputLimiters[i];
+        for (std::size_t i = 0; i < _next->outputs.size(); ++i) _next->outputs[i].enableLimiter = scene.outputLimiters[i];
+        _next->fadeFrom = std::move(_from);
+        _next->fadeTo = scene;
+        _next->fadeLength = std::max(static_cast<std::size_t>(ms * 0.001 * Controller::sampleRate), std::size_t{ 1 });
+        _next->fadePosition = 0;
+        _next->startsFade = true;
+        publish(std::move(_next));
+        return true;
+    }
+
+    double Processor::controllerGain(int value) {
+        static const std::vector<double> _table = [] {
+            std::vector<double> _result(16384);
+            for (std::size_t i = 0; i < _result.size(); ++i)
+                _result[i] = std::pow(Controller::maxLin * i / 16383., 4);
+            return _result;
+        }();
+        return _table[std::clamp(value, 0, 16383)];
+    }
+
+    void Processor::apply(const ParameterChange& change) {
+        if (change.generation != generation) return; // Channels changed since
+        auto& _inputs = _live->inputs;
+        auto& _outputs = _live->outputs;
+        if (change.input) {
+            if (static_cast<std::size_t>(change.channel) < _inputs.size()) _inputs[change.channel].set(change.link, change.value);
+        } else {
+            if (static_cast<std::size_t>(change.channel) < _outputs.size()) _outputs[change.channel].set(change.link, change.value);
+        }
+    }
+
+    void Processor::applyChanges(std::uint64_t time) {
+        while (_hasChange || (_hasChange = changes.pop(_change))) {
+            if (_change.time > time) return;
+            apply(_change);
+            _hasChange = false;
+        }
+    }
+
+    void Processor::publishClock(std::size_t frames) {
+        const auto _now = std::chrono::steady_clock::now().time_since_epoch();
+        _clockSequence.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        _clockSample.store(_sampleTime, std::memory_order_relaxed);
+        _clockFrames.store(frames, std::memory_order_relaxed);
+        _clockNanos.store(std::chrono::duration_cast<std::chrono::nanoseconds>(_now).count(), std::memory_order_relaxed);
+        _clockSequence.fetch_add(1, std::memory_order_release);
+    }
+
+    std::uint64_t Processor::timestamp() const {
+        std::uint64_t _sample, _frames;
+        std::int64_t _nanos;
+        for (;;) {
+            const auto _sequence = _clockSequence.load(std::memory_order_acquire);
+            _sample = _clockSample.load(std::memory_order_relaxed);
+            _frames = _clockFrames.load(std::memory_order_relaxed);
+            _nanos = _clockNanos.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (_sequence % 2 == 0 && _sequence == _clockSequence.load(std::memory_order_relaxed)) break;
+        }
+
+        const auto _now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        const double _elapsed = std::max(_now - _nanos, std::int64_t{ 0 }) * 1e-9 * Controller::sampleRate;
+        const std::uint64_t _offset = _frames == 0 ? 0 
+            : std::min(static_cast<std::uint64_t>(_elapsed), _frames - 1);
+        return _sample + _frames + _offset;
     }
 }
\ No newline at end of file
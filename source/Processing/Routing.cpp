@@ -0,0 +1,23 @@
+#include "Processing/Routing.hpp"
+#include "Utils.hpp"
+
+namespace Mixijo {
+
+    std::optional<RoutingLine> RoutingLine::parse(std::string_view line) {
+        if (!line.contains(":") || line.starts_with("#")) return {};
+        auto _parts = split(line, ':');
+        if (_parts.size() < 2) return {};
+
+        RoutingLine _line{ .channel = trim(_parts[0]), .input = _parts.size() == 3 };
+        for (auto _setting : split(trim(_parts[1], " \t\n\r\f\v[]"), ',')) {
+            auto _pair = split(trim(_setting), '=');
+            if (_pair.size() < 2) continue; // Setting is 'name=val'
+            _line.settings.emplace_back(trim(_pair[0]), Mixijo::parse<double>(trim(_pair[1])));
+        }
+
+        if (_line.input)
+            for (auto _name : split(trim(_parts[2], " \t\n\r\f\v[]"), ','))
+                _line.outputs.push_back(trim(_name));
+        return _line;
+    }
+}
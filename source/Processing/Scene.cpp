@@ -0,0 +1,56 @@
+#include "Processing/Scene.hpp"
+
+namespace Mixijo {
+
+    std::string Scene::serialize() const {
+        std::string _data;
+        const auto _write = [&](const void* data, std::size_t bytes) {
+            _data.append(static_cast<const char*>(data), bytes);
+        };
+        const auto _writeVector = [&](const auto& vector) {
+            _write(vector.data(), vector.size() * sizeof(vector[0]));
+        };
+
+        const std::uint32_t _inputs = inputGains.size();
+        const std::uint32_t _outputs = outputGains.size();
+        _write(&magic, sizeof(magic));
+        _write(&version, sizeof(version));
+        _write(&layout, sizeof(layout));
+        _write(&_inputs, sizeof(_inputs));
+        _write(&_outputs, sizeof(_outputs));
+        _writeVector(inputGains);
+        _writeVector(outputGains);
+        _writeVector(inputLimiters);
+        _writeVector(outputLimiters);
+        _writeVector(levels);
+        return _data;
+    }
+
+    std::optional<Scene> Scene::deserialize(std::string_view data) {
+        const auto _read = [&](void* dest, std::size_t bytes) {
+            if (data.size() < bytes) return false;
+            std::memcpy(dest, data.data(), bytes);
+            data.remove_prefix(bytes);
+            return true;
+        };
+        const auto _readVector = [&](auto& vector, std::size_t size) {
+            if (data.size() < size * sizeof(vector[0])) return false;
+            vector.resize(size);
+            return _read(vector.data(), size * sizeof(vector[0]));
+        };
+
+        Scene _scene;
+        std::uint32_t _magic = 0, _version = 0, _inputs = 0, _outputs = 0;
+        if (!_read(&_magic, sizeof(_magic)) || _magic != magic) return {};
+        if (!_read(&_version, sizeof(_version)) || _version != version) return {};
+        if (!_read(&_scene.layout, sizeof(_scene.layout))) return {};
+        if (!_read(&_inputs, sizeof(_inputs)) || !_read(&_outputs, sizeof(_outputs))) return {};
+        if (!_readVector(_scene.inputGains, _inputs)) return {};
+        if (!_readVector(_scene.outputGains, _outputs)) return {};
+        if (!_readVector(_scene.inputLimiters, _inputs)) return {};
+        if (!_readVector(_scene.outputLimiters, _outputs)) return {};
+        if (!_readVector(_scene.levels, std::size_t{ _inputs } * _outputs)) return {};
+        if (!data.empty()) return {};
+        return _scene;
+    }
+}
@@ -0,0 +1,111 @@
+#include "Realtime.hpp"
+
+#if __has_include(<stacktrace>)
+#include <stacktrace>
+#endif
+
+namespace Mixijo {
+
+    std::mutex Realtime::_lock{};
+    std::vector<Realtime::Violation> Realtime::_violations{};
+    std::atomic<std::size_t> Realtime::_count{ 0 };
+    std::size_t Realtime::_reported = 0;
+    thread_local bool Realtime::_realtime = false;
+    thread_local bool Realtime::_recording = false;
+
+    Realtime::Scope::Scope()
+        : _previous(_realtime)
+    {
+        _realtime = true;
+    }
+
+    Realtime::Scope::~Scope() { _realtime = _previous; }
+
+    Realtime::Allow::Allow()
+        : _previous(_realtime)
+    {
+        _realtime = false;
+    }
+
+    Realtime::Allow::~Allow() { _realtime = _previous; }
+
+    void Realtime::check(const char* what) {
+        if (!_realtime || _recording) return;
+        _recording = true;
+        _count.fetch_add(1, std::memory_order_relaxed);
+        {
+            std::scoped_lock _{ _lock };
+            if (_violations.size() < MaxViolations)
+#ifdef __cpp_lib_stacktrace
+                _violations.push_back({ what, std::to_string(std::stacktrace::current(1)) });
+#else
+                _violations.push_back({ what, "no stack trace, the standard library can't make them" });
+#endif
+        }
+        _recording = false;
+    }
+
+    std::size_t Realtime::report(const std::function<void(std::string_view)>& log) {
+        const std::size_t _total = _count.load(std::memory_order_relaxed);
+        if (_total == _reported) return _total;
+
+        std::scoped_lock _{ _lock };
+        for (std::size_t i = std::min(_reported, _violations.size()); i < _violations.size(); ++i)
+            log(std::format("Realtime violation on the audio thread ({}):\n{}", _violations[i].what, _violations[i].trace));
+        if (_total > MaxViolations && _reported <= MaxViolations)
+            log(std::format("More than {} realtime violations, only the first ones are shown", MaxViolations));
+        _reported = _total;
+        return _total;
+    }
+}
+
+#ifdef MIXIJO_RT_CHECK
+void* operator new(std::size_t size) {
+    Mixijo::Realtime::check("allocation");
+    if (void* _data = std::malloc(size ? size : 1)) return _data;
+    throw std::bad_alloc{};
+}
+
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    Mixijo::Realtime::check("allocation");
+    const auto _alignment = static_cast<std::size_t>(alignment);
+#ifdef _WIN32
+    if (void* _data = _aligned_malloc(size ? size : 1, _alignment)) return _data;
+#else
+    if (void* _data = std::aligned_alloc(_alignment, (std::max(size, std::size_t{ 1 }) + _alignment - 1) / _alignment * _alignment)) return _data;
+#endif
+    throw std::bad_alloc{};
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return ::operator new(size, alignment);
+}
+
+void operator delete(void* data) noexcept {
+    if (!data) return;
+    Mixijo::Realtime::check("free");
+    std::free(data);
+}
+
+void operator delete[](void* data) noexcept { ::operator delete(data); }
+void operator delete(void* data, std::size_t) noexcept { ::operator delete(data); }
+void operator delete[](void* data, std::size_t) noexcept { ::operator delete(data); }
+
+void operator delete(void* data, std::align_val_t) noexcept {
+    if (!data) return;
+    Mixijo::Realtime::check("free");
+#ifdef _WIN32
+    _aligned_free(data);
+#else
+    std::free(data);
+#endif
+}
+
+void operator delete[](void* data, std::align_val_t alignment) noexcept { ::operator delete(data, alignment); }
+void operator delete(void* data, std::size_t, std::align_val_t alignment) noexcept { ::operator delete(data, alignment); }
+void operator delete[](void* data, std::size_t, std::align_val_t alignment) noexcept { ::operator delete(data, alignment); }
+#endif
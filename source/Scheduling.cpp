@@ -0,0 +1,85 @@
+#include "Scheduling.hpp"
+#include "Controller.hpp"
+
+#include <avrt.h>
+
+namespace Mixijo {
+
+    std::atomic<bool> Scheduling::_realtime{ true };
+    std::atomic<bool> Scheduling::_lockMemory{ false };
+    std::array<std::atomic<std::uint64_t>, Scheduling::Threads> Scheduling::_affinity{};
+    std::atomic<std::size_t> Scheduling::_generation{ 1 }; // Threads start at 0, so they all apply once
+
+    void Scheduling::configure(const Settings& settings) {
+        _realtime.store(settings.realtime, std::memory_order_relaxed);
+        _lockMemory.store(settings.lockMemory, std::memory_order_relaxed);
+        for (std::size_t i = 0; i < Threads; ++i)
+            _affinity[i].store(settings.affinity[i], std::memory_order_relaxed);
+        _generation.fetch_add(1, std::memory_order_release);
+    }
+
+    void Scheduling::apply(Thread thread) {
+        thread_local std::size_t _applied = 0;
+        thread_local HANDLE _task = nullptr; // MMCSS task of the audio thread
+        const std::size_t _current = _generation.load(std::memory_order_acquire);
+        if (_current == _applied) return;
+        _applied = _current;
+
+        // Might be the audio thread, so only use the lock-free logger
+        auto& _log = Controller::logger;
+        const char* _name = Names[thread];
+        const bool _wantRealtime = _realtime.load(std::memory_order_relaxed);
+
+        if (thread == Audio) {
+            if (_wantRealtime && !_task) {
+                DWORD _index = 0;
+                _task = AvSetMmThreadCharacteristicsA("Pro Audio", &_index);
+                if (!_task) _log.errline("Couldn't give the audio thread realtime priority, joining the Pro Audio MMCSS task failed (error ", GetLastError(), ")");
+                else if (!AvSetMmThreadPriority(_task, AVRT_PRIORITY_CRITICAL)) _log.errline("Couldn't raise the MMCSS priority of the audio thread (error ", GetLastError(), ")");
+                else _log.logline("Audio thread joined the Pro Audio MMCSS task");
+            } else if (!_wantRealtime && _task) {
+                AvRevertMmThreadCharacteristics(_task);
+                _task = nullptr;
+            }
+        } else {
+            // Midi feedback has to be on time, the gui and midi-in a bit less, the analyzer is only a view
+            const int _priority = !_wantRealtime ? THREAD_PRIORITY_NORMAL
+                : thread == Feedback ? THREAD_PRIORITY_HIGHEST
+                : thread == Main ? THREAD_PRIORITY_ABOVE_NORMAL
+                : THREAD_PRIORITY_NORMAL;
+            if (!SetThreadPriority(GetCurrentThread(), _priority))
+                _log.errline("Couldn't set the priority of the ", _name, " thread (error ", GetLastError(), ")");
+        }
+
+        DWORD_PTR _available = 0, _system = 0;
+        if (!GetProcessAffinityMask(GetCurrentProcess(), &_available, &_system)) return;
+        const auto _mask = static_cast<DWORD_PTR>(_affinity[thread].load(std::memory_order_relaxed));
+        if (_mask & ~_available) _log.errline("The ", _name, " thread is pinned to cpus that aren't available, those are ignored");
+        const DWORD_PTR _use = (_mask & _available) ? (_mask & _available) : _available;
+        if (!SetThreadAffinityMask(GetCurrentThread(), _use))
+            _log.errline("Couldn't pin the ", _name, " thread to its cpus (error ", GetLastError(), ")");
+    }
+
+    bool Scheduling::lock(const void* data, std::size_t bytes) {
+        if (!lockMemory() || !data || bytes == 0) return false;
+
+        // VirtualLock is limited by the minimum working set, so grow it by what we lock
+        HANDLE _process = GetCurrentProcess();
+        SIZE_T _min = 0, _max = 0;
+        if (!GetProcessWorkingSetSize(_process, &_min, &_max)
+            || !SetProcessWorkingSetSize(_process, _min + bytes, std::max<SIZE_T>(_max, _min + bytes))) {
+            Controller::errline("Couldn't grow the working set to lock ", bytes, " bytes of engine memory (error ", GetLastError(), "), it might be paged out");
+            return false;
+        }
+
+        if (!VirtualLock(const_cast<void*>(data), bytes)) {
+            Controller::errline("Couldn't lock ", bytes, " bytes of engine memory in RAM (error ", GetLastError(), "), it might be paged out");
+            return false;
+        }
+        return true;
+    }
+
+    void Scheduling::unlock(const void* data, std::size_t bytes) {
+        VirtualUnlock(const_cast<void*>(data), bytes);
+    }
+}
@@ -0,0 +1,87 @@
+#include "Trace.hpp"
+
+namespace Mixijo {
+
+    std::mutex Trace::_lock{};
+    std::vector<std::unique_ptr<Trace::Buffer>> Trace::_buffers{};
+    const std::chrono::steady_clock::time_point Trace::_start = std::chrono::steady_clock::now();
+
+    Trace::Zone::Zone(const char* name)
+        : _name(name), _begin(now())
+    {}
+
+    Trace::Zone::~Zone() {
+        Buffer& _buffer = local();
+        const std::size_t _index = _buffer.written.load(std::memory_order_relaxed);
+        Slot& _slot = _buffer.slots[_index % Capacity];
+        _slot.name.store(_name, std::memory_order_relaxed);
+        _slot.begin.store(_begin, std::memory_order_relaxed);
+        _slot.end.store(now(), std::memory_order_relaxed);
+        _buffer.written.store(_index + 1, std::memory_order_release);
+    }
+
+    void Trace::thread(const char* name) {
+        local().name.store(name, std::memory_order_relaxed);
+    }
+
+    std::string Trace::dump() {
+        std::vector<Buffer*> _threads;
+        {
+            std::scoped_lock _{ _lock };
+            for (auto& _buffer : _buffers) _threads.push_back(_buffer.get());
+        }
+
+        std::string _result = "{\"traceEvents\":[\n";
+        bool _first = true;
+        const auto _append = [&](std::string_view event) {
+            if (!_first) _result += ",\n";
+            _first = false;
+            _result += event;
+        };
+
+        for (Buffer* _buffer : _threads) {
+            if (const char* _name = _buffer->name.load(std::memory_order_relaxed))
+                _append(std::format(R"({{"name":"thread_name","ph":"M","pid":1,"tid":{},"args":{{"name":"{}"}}}})", _buffer->id, _name));
+
+            const std::size_t _written = _buffer->written.load(std::memory_order_acquire);
+            const std::size_t _from = _written > Capacity ? _written - Capacity : 0;
+            for (std::size_t i = _from; i < _written; ++i) {
+                const Slot& _slot = _buffer->slots[i % Capacity];
+                const char* _name = _slot.name.load(std::memory_order_relaxed);
+                const std::int64_t _begin = _slot.begin.load(std::memory_order_relaxed);
+                const std::int64_t _end = _slot.end.load(std::memory_order_relaxed);
+                // The thread might have wrapped around and overwritten this slot while we read it
+                if (i + Capacity < _buffer->written.load(std::memory_order_acquire) + 1) continue;
+                _append(std::format(R"({{"name":"{}","ph":"X","pid":1,"tid":{},"ts":{:.3f},"dur":{:.3f}}})",
+                    _name, _buffer->id, _begin / 1000., (_end - _begin) / 1000.));
+            }
+        }
+        _result += "\n]}\n";
+        return _result;
+    }
+
+    Trace::Buffer& Trace::local() {
+        // Buffers of threads that ended are reused, so threads that are restarted don't add up
+        struct Owner {
+            Buffer* buffer = nullptr;
+            ~Owner() { if (buffer) buffer->used.store(false, std::memory_order_release); }
+        };
+        thread_local Owner _owner;
+        if (!_owner.buffer) {
+            std::scoped_lock _{ _lock };
+            for (auto& _buffer : _buffers)
+                if (!_buffer->used.load(std::memory_order_acquire)) _owner.buffer = _buffer.get();
+            if (!_owner.buffer) {
+                _owner.buffer = _buffers.emplace_back(std::make_unique<Buffer>()).get();
+                _owner.buffer->id = _buffers.size();
+            }
+            _owner.buffer->used.store(true, std::memory_order_relaxed);
+            _owner.buffer->name.store(nullptr, std::memory_order_relaxed);
+        }
+        return *_owner.buffer;
+    }
+
+    std::int64_t Trace::now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _start).count();
+    }
+}
@@ -0,0 +1,118 @@
+#include "Writer.hpp"
+#include "Controller.hpp"
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace Mixijo {
+
+    Writer::Writer(std::chrono::milliseconds debounce)
+        : _debounce(debounce)
+    {}
+
+    Writer::~Writer() { stop(); }
+
+    void Writer::start() {
+        std::scoped_lock _{ _lock };
+        if (_running) return;
+        _running = true;
+        _thread = std::thread{ [this] { run(); } };
+    }
+
+    void Writer::stop() {
+        {
+            std::scoped_lock _{ _lock };
+            if (!_running) return;
+            _running = false;
+        }
+        _condition.notify_all();
+        _thread.join();
+    }
+
+    void Writer::post(const std::filesystem::path& path, Serializer serializer) {
+        std::unique_lock _guard{ _lock };
+        const auto _now = std::chrono::steady_clock::now();
+        if (_pending.empty()) _firstPost = _now;
+        _deadline = _now + _debounce;
+
+        auto _it = std::find_if(_pending.begin(), _pending.end(), [&](auto& p) { return p.path == path; });
+        if (_it != _pending.end()) _it->serializer = std::move(serializer);
+        else _pending.push_back({ path, std::move(serializer) });
+
+        if (!_running) return writeAll(_guard); // No writer thread, write right away
+        _guard.unlock();
+        _condition.notify_one();
+    }
+
+    void Writer::flush() {
+        std::unique_lock _guard{ _lock };
+        if (!_running) return writeAll(_guard);
+        _flush = true;
+        _condition.notify_one();
+        _written.wait(_guard, [&] { return _pending.empty() && !_writing; });
+    }
+
+    void Writer::run() {
+        std::unique_lock _guard{ _lock };
+        while (_running) {
+            if (_pending.empty()) {
+                _flush = false;
+                _condition.wait(_guard, [&] { return !_running || !_pending.empty(); });
+                continue;
+            }
+
+            // Wait until no more writes come in, but never longer than 8 times the debounce
+            const auto _limit = _firstPost + 8 * _debounce;
+            if (!_flush && _condition.wait_until(_guard, std::min(_deadline, _limit),
+                [&] { return !_running || _flush; })) continue;
+            if (!_flush && std::chrono::steady_clock::now() < std::min(_deadline, _limit)) continue;
+
+            writeAll(_guard);
+        }
+        writeAll(_guard); // Write what's left before stopping
+    }
+
+    void Writer::writeAll(std::unique_lock<std::mutex>& guard) {
+        _flush = false;
+        _writing = true;
+        auto _pending = std::move(this->_pending);
+        this->_pending.clear();
+
+        guard.unlock();
+        for (auto& _write : _pending) {
+            if (!writeAtomic(_write.path, _write.serializer()))
+                Controller::errline("Failed to write file (", _write.path.string(), ")");
+        }
+        guard.lock();
+
+        _writing = false;
+        _written.notify_all();
+    }
+
+    bool Writer::writeAtomic(const std::filesystem::path& path, std::string_view content) {
+        auto _temp = path;
+        _temp += ".tmp";
+
+        std::FILE* _file = std::fopen(_temp.string().c_str(), "wb");
+        if (!_file) return false;
+        bool _success = std::fwrite(content.data(), 1, content.size(), _file) == content.size();
+        _success &= std::fflush(_file) == 0;
+#ifdef _WIN32
+        _success &= _commit(_fileno(_file)) == 0;
+#else
+        _success &= fsync(fileno(_file)) == 0;
+#endif
+        _success &= std::fclose(_file) == 0;
+
+        std::error_code _error;
+        if (_success) std::filesystem::rename(_temp, path, _error);
+        if (!_success || _error) {
+            std::filesystem::remove(_temp, _error);
+            return false;
+        }
+        return true;
+    }
+}
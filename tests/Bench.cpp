@@ -0,0 +1,154 @@
+#include "Bench.hpp"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Mixijo::Bench {
+
+    const void* volatile sink = nullptr;
+
+    static std::vector<std::pair<std::string_view, std::function<void(void)>>>& benchmarks() {
+        static std::vector<std::pair<std::string_view, std::function<void(void)>>> _benchmarks;
+        return _benchmarks;
+    }
+
+    Register::Register(std::string_view name, std::function<void(void)> run) {
+        benchmarks().emplace_back(name, std::move(run));
+    }
+
+    struct Counters {
+        double cacheReferences = -1; // -1 when not available
+        double cacheMisses = -1;
+    };
+
+    /**
+     * Counts cache references and misses of the calling thread, only on linux,
+     * and only when the kernel allows it. Virtual machines often don't.
+     */
+    class Counter {
+    public:
+        Counter() {
+#ifdef __linux__
+            const auto _open = [](std::uint64_t config, int group) {
+                perf_event_attr _attr{};
+                _attr.size = sizeof(perf_event_attr);
+                _attr.type = PERF_TYPE_HARDWARE;
+                _attr.config = config;
+                _attr.disabled = group == -1;
+                _attr.exclude_kernel = 1;
+                _attr.exclude_hv = 1;
+                return static_cast<int>(syscall(SYS_perf_event_open, &_attr, 0, -1, group, 0));
+            };
+            _references = _open(PERF_COUNT_HW_CACHE_REFERENCES, -1);
+            if (_references != -1) _misses = _open(PERF_COUNT_HW_CACHE_MISSES, _references);
+#endif
+        }
+
+        ~Counter() {
+#ifdef __linux__
+            if (_misses != -1) close(_misses);
+            if (_references != -1) close(_references);
+#endif
+        }
+
+        bool available() const { return _misses != -1; }
+
+        void start() {
+#ifdef __linux__
+            if (!available()) return;
+            ioctl(_references, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(_references, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+        }
+
+        Counters stop(double calls) {
+            Counters _result{};
+#ifdef __linux__
+            if (!available()) return _result;
+            ioctl(_references, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+            std::uint64_t _referenceCount = 0, _missCount = 0;
+            if (read(_references, &_referenceCount, sizeof(_referenceCount)) != sizeof(_referenceCount)) return _result;
+            if (read(_misses, &_missCount, sizeof(_missCount)) != sizeof(_missCount)) return _result;
+            _result.cacheReferences = _referenceCount / calls;
+            _result.cacheMisses = _missCount / calls;
+#endif
+            return _result;
+        }
+
+    private:
+        int _references = -1;
+        int _misses = -1;
+    };
+
+    static std::string duration(double ns) {
+        if (ns < 1e3) return std::format("{:.1f} ns", ns);
+        if (ns < 1e6) return std::format("{:.2f} us", ns / 1e3);
+        return std::format("{:.2f} ms", ns / 1e6);
+    }
+
+    double measure(std::string_view name, const std::function<void(void)>& fn, double items) {
+        using clock = std::chrono::steady_clock;
+        constexpr auto _budget = std::chrono::milliseconds(400);
+
+        // Find how many calls take a tenth of the budget, then keep the fastest batch
+        std::size_t _calls = 1;
+        for (;;) {
+            const auto _start = clock::now();
+            for (std::size_t i = 0; i < _calls; ++i) fn();
+            if (clock::now() - _start >= _budget / 10 || _calls >= (std::size_t{ 1 } << 30)) break;
+            _calls *= 2;
+        }
+
+        static Counter _counter;
+        double _best = std::numeric_limits<double>::max();
+        Counters _counters{};
+        const auto _end = clock::now() + _budget;
+        do {
+            _counter.start();
+            const auto _start = clock::now();
+            for (std::size_t i = 0; i < _calls; ++i) fn();
+            const double _ns = std::chrono::duration<double, std::nano>(clock::now() - _start).count() / _calls;
+            const Counters _batch = _counter.stop(static_cast<double>(_calls));
+            if (_ns < _best) _best = _ns, _counters = _batch;
+        } while (clock::now() < _end);
+
+        std::string _line = std::format("  {:<44} {:>12}", name, duration(_best));
+        if (items > 0) _line += std::format("  {:>12} per item", duration(_best / items));
+        if (_counters.cacheMisses >= 0)
+            _line += std::format("  {:.1f} cache misses, {:.1f} references", _counters.cacheMisses, _counters.cacheReferences);
+        note(_line);
+        return _best;
+    }
+
+    void note(std::string_view line) {
+        std::cout << line << '\n';
+    }
+}
+
+int main(int argc, char** argv) {
+    // Without arguments everything runs, otherwise only the named benchmarks
+    const auto _selected = [&](std::string_view name) {
+        if (argc < 2) return true;
+        for (int i = 1; i < argc; ++i) if (name == argv[i]) return true;
+        return false;
+    };
+
+    int _ran = 0;
+    for (auto& [_name, _run] : Mixijo::Bench::benchmarks()) {
+        if (!_selected(_name)) continue;
+        std::cout << _name << '\n';
+        _run();
+        ++_ran;
+    }
+
+    if (_ran == 0) {
+        std::cout << "No benchmark with that name, there are:\n";
+        for (auto& [_name, _] : Mixijo::Bench::benchmarks()) std::cout << "  " << _name << '\n';
+        return 1;
+    }
+    return 0;
+}
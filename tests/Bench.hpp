@@ -0,0 +1,40 @@
+#pragma once
+#include "pch.hpp"
+
+namespace Mixijo::Bench {
+
+    /**
+     * Registers a benchmark, construct it at namespace scope.
+     */
+    struct Register {
+        Register(std::string_view name, std::function<void(void)> run);
+    };
+
+    extern const void* volatile sink; // Written by keep, never read
+
+    /**
+     * Keep the compiler from optimizing away the computation of a value.
+     * @param value value that has to be computed
+     */
+    template<class Ty>
+    void keep(const Ty& value) {
+        sink = &value;
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+    }
+
+    /**
+     * Run a function in batches for a while, and report the fastest batch,
+     * with its cache misses when the platform can count them.
+     * @param name what is measured
+     * @param fn function to measure
+     * @param items items one call processes, the time is also reported per item
+     * @return nanoseconds per call
+     */
+    double measure(std::string_view name, const std::function<void(void)>& fn, double items = 0);
+
+    /**
+     * Print a line in the report of the current benchmark.
+     * @param line text
+     */
+    void note(std::string_view line);
+}
@@ -0,0 +1,137 @@
+#include "Golden.hpp"
+#include "Utils.hpp"
+
+namespace Mixijo::Golden {
+
+    struct Case {
+        std::string_view name;
+        std::function<Rows(void)> run;
+        Tolerance tolerance;
+    };
+
+    static std::vector<Case>& cases() {
+        static std::vector<Case> _cases;
+        return _cases;
+    }
+
+    Register::Register(std::string_view name, std::function<Rows(void)> run, Tolerance tolerance) {
+        cases().push_back({ name, std::move(run), tolerance });
+    }
+
+    static std::filesystem::path path(std::string_view name) {
+        return std::filesystem::path{ MIXIJO_GOLDEN_DIR } / std::format("{}.golden", name);
+    }
+
+    // Shortest representation that reads back to the same double
+    static std::string serialize(const Rows& rows) {
+        std::string _result;
+        char _buffer[32];
+        for (auto& _row : rows) {
+            for (std::size_t i = 0; i < _row.size(); ++i) {
+                if (i != 0) _result += ' ';
+                auto [_end, _] = std::to_chars(std::begin(_buffer), std::end(_buffer), _row[i]);
+                _result.append(_buffer, _end);
+            }
+            _result += '\n';
+        }
+        return _result;
+    }
+
+    static std::optional<Rows> deserialize(std::string_view content) {
+        Rows _rows;
+        for (auto _line : split(content, '\n')) {
+            if (trim(_line).empty()) continue;
+            auto& _row = _rows.emplace_back();
+            for (auto _value : split(trim(_line), ' ')) {
+                double _parsed = 0;
+                auto [_ptr, _error] = std::from_chars(_value.data(), _value.data() + _value.size(), _parsed);
+                if (_error != std::errc{} || _ptr != _value.data() + _value.size()) return {};
+                _row.push_back(_parsed);
+            }
+        }
+        return _rows;
+    }
+
+    // Distance in representable doubles, also across zero
+    static std::uint64_t ulps(double a, double b) {
+        const auto _ordered = [](double value) {
+            const auto _bits = std::bit_cast<std::uint64_t>(value);
+            return (_bits >> 63) ? ~_bits : _bits | (std::uint64_t{ 1 } << 63);
+        };
+        const std::uint64_t _a = _ordered(a), _b = _ordered(b);
+        return _a > _b ? _a - _b : _b - _a;
+    }
+
+    static bool matches(double actual, double expected, const Tolerance& tolerance) {
+        if (ulps(actual, expected) <= tolerance.ulps) return true;
+        const double _floor = std::pow(10., tolerance.floor / 20.);
+        if (std::abs(actual) <= _floor && std::abs(expected) <= _floor) return true;
+        if (tolerance.db == 0 || (actual < 0) != (expected < 0) || actual == 0 || expected == 0) return false;
+        return std::abs(20 * std::log10(actual / expected)) <= tolerance.db;
+    }
+
+    /**
+     * @return empty when the output matches, otherwise what didn't
+     */
+    static std::string compare(const Rows& actual, const Rows& expected, const Tolerance& tolerance) {
+        if (actual.size() != expected.size())
+            return std::format("{} frames, the golden file has {}", actual.size(), expected.size());
+
+        std::size_t _mismatches = 0;
+        std::string _first;
+        for (std::size_t i = 0; i < actual.size(); ++i) {
+            if (actual[i].size() != expected[i].size())
+                return std::format("{} endpoints in frame {}, the golden file has {}", actual[i].size(), i, expected[i].size());
+            for (std::size_t j = 0; j < actual[i].size(); ++j) {
+                if (matches(actual[i][j], expected[i][j], tolerance)) continue;
+                if (_mismatches++ == 0) _first = std::format("frame {} endpoint {} is {}, expected {}, {} ulps apart",
+                    i, j, actual[i][j], expected[i][j], ulps(actual[i][j], expected[i][j]));
+            }
+        }
+        if (_mismatches == 0) return {};
+        return std::format("{} values differ, the first: {}", _mismatches, _first);
+    }
+}
+
+int main(int argc, char** argv) {
+    using namespace Mixijo;
+    using namespace Mixijo::Golden;
+
+    // --update writes the golden files instead of comparing, other arguments select cases
+    bool _update = false;
+    std::vector<std::string_view> _selected;
+    for (int i = 1; i < argc; ++i) {
+        if (std::string_view{ argv[i] } == "--update") _update = true;
+        else _selected.push_back(argv[i]);
+    }
+
+    int _failed = 0, _ran = 0;
+    for (auto& _case : cases()) {
+        if (!_selected.empty() && std::ranges::find(_selected, _case.name) == _selected.end()) continue;
+        ++_ran;
+        const Rows _rows = _case.run();
+
+        if (_update) {
+            std::ofstream{ path(_case.name), std::ios::binary } << serialize(_rows);
+            std::cout << "updated " << _case.name << '\n';
+            continue;
+        }
+
+        const std::optional<std::string> _content = readFile(path(_case.name));
+        const std::optional<Rows> _expected = _content ? deserialize(_content.value()) : std::nullopt;
+        std::string _error = !_content ? "no golden file, run with --update to write it"
+            : !_expected ? "the golden file is invalid"
+            : compare(_rows, _expected.value(), _case.tolerance);
+
+        std::cout << (_error.empty() ? "ok     " : "FAILED ") << _case.name;
+        if (!_error.empty()) std::cout << ": " << _error, ++_failed;
+        std::cout << '\n';
+    }
+
+    if (_ran == 0) {
+        std::cout << "No case with that name, there are:\n";
+        for (auto& _case : cases()) std::cout << "  " << _case.name << '\n';
+        return 1;
+    }
+    return _failed == 0 ? 0 : 1;
+}
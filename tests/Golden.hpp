@@ -0,0 +1,29 @@
+#pragma once
+#include "pch.hpp"
+
+namespace Mixijo::Golden {
+
+    /**
+     * Output of a case, one row per frame, one column per endpoint.
+     */
+    using Rows = std::vector<std::vector<double>>;
+
+    /**
+     * How far the output may be from the golden file. A value matches when
+     * it's within ulps of the golden value, or within db of it with the same
+     * sign, or when both are below the floor.
+     */
+    struct Tolerance {
+        std::uint64_t ulps = 4;
+        double db = 0;        // 0 to only compare the ulps
+        double floor = -240;  // dB, values this small are both silence
+    };
+
+    /**
+     * Registers a case, construct it at namespace scope. Its output is
+     * compared against golden/<name>.golden.
+     */
+    struct Register {
+        Register(std::string_view name, std::function<Rows(void)> run, Tolerance tolerance = {});
+    };
+}
@@ -0,0 +1,117 @@
+#include "Jack/Client.hpp"
+#include <csignal>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+// Runs the JACK client on jackd with the dummy driver, so it runs on a headless machine. A probe
+// client plays a constant into an input port of the mixer and reads one of its output ports back.
+// Skipped when jackd isn't installed.
+namespace Mixijo {
+
+    constexpr int Skipped = 77; // SKIP_RETURN_CODE of the test
+    static int failures = 0;
+
+    static void expect(std::string_view name, bool ok, std::string_view detail = {}) {
+        if (!ok) ++failures;
+        std::cout << (ok ? "ok     " : "FAILED ") << name;
+        if (!ok && !detail.empty()) std::cout << ": " << detail;
+        std::cout << '\n';
+    }
+
+    /**
+     * Client that plays a constant into its output port, and keeps the last sample of its input port.
+     */
+    struct Probe {
+        constexpr static float level = 0.25f;
+
+        jack_client_t* client = nullptr;
+        jack_port_t* signal = nullptr;
+        jack_port_t* result = nullptr;
+        std::atomic<float> received{ 0 };
+        std::atomic<std::size_t> blocks{ 0 };
+
+        bool open(const std::string& server) {
+            const auto _options = static_cast<jack_options_t>(JackNoStartServer | JackServerName);
+            client = jack_client_open("probe", _options, nullptr, server.c_str());
+            if (!client) return false;
+            signal = jack_port_register(client, "signal", JACK_DEFAULT_AUDIO_TYPE, JackPortIsOutput, 0);
+            result = jack_port_register(client, "result", JACK_DEFAULT_AUDIO_TYPE, JackPortIsInput, 0);
+            jack_set_process_callback(client, [](jack_nframes_t frames, void* self) {
+                auto& _probe = *static_cast<Probe*>(self);
+                std::fill_n(static_cast<float*>(jack_port_get_buffer(_probe.signal, frames)), frames, level);
+                _probe.received = static_cast<const float*>(jack_port_get_buffer(_probe.result, frames))[frames - 1];
+                ++_probe.blocks;
+                return 0;
+            }, this);
+            return signal && result && jack_activate(client) == 0;
+        }
+
+        ~Probe() { if (client) jack_client_close(client); }
+    };
+}
+
+int main() {
+    using namespace Mixijo;
+
+    if (std::system("command -v jackd > /dev/null 2>&1") != 0) {
+        std::cout << "skipped: jackd isn't installed\n";
+        return Skipped;
+    }
+
+    // Own server, so it doesn't touch a server that's already running
+    const std::string _server = std::format("mixijo-test-{}", getpid());
+    std::vector<std::string> _arguments{ "jackd", "--no-realtime", "--name", _server, "-d", "dummy", "-r", "48000", "-p", "256" };
+    std::vector<char*> _argv;
+    for (auto& _argument : _arguments) _argv.push_back(_argument.data());
+    _argv.push_back(nullptr);
+    pid_t _jackd = 0;
+    if (posix_spawnp(&_jackd, "jackd", nullptr, nullptr, _argv.data(), environ) != 0) {
+        std::cout << "skipped: couldn't start jackd\n";
+        return Skipped;
+    }
+
+    Probe _probe;
+    const auto _deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!_probe.open(_server) && std::chrono::steady_clock::now() < _deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    expect("jackd started with the dummy driver", _probe.client != nullptr);
+
+    if (_probe.client) {
+        std::optional<json> _settings = json::parse(R"({ "channels" : {
+            "outputs" : [ { "endpoints" : [ "Speakers 1" ], "name" : "Speakers" } ],
+            "inputs" : [ { "endpoints" : [ "Speakers 1" ], "name" : "Loopback" } ]
+        } })");
+
+        Jack::Client _client;
+        expect("client opened", _client.open("mixijo", _settings.value(), _server));
+        expect("ports are named after the endpoints",
+            _client.ports(true) == std::vector<std::string>{ "mixijo:in Speakers 1" }
+            && _client.ports(false) == std::vector<std::string>{ "mixijo:out Speakers 1" });
+
+        _client.route({ "Speakers:[gain=0.5]", "Loopback:[gain=1]:[Speakers]" });
+        expect("client activated", _client.activate());
+        jack_connect(_probe.client, "probe:signal", "mixijo:in Speakers 1");
+        jack_connect(_probe.client, "mixijo:out Speakers 1", "probe:result");
+
+        // The probe reads the output of the previous cycle, give the graph a few cycles
+        const std::size_t _start = _probe.blocks;
+        const auto _timeout = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (_probe.blocks < _start + 32 && std::chrono::steady_clock::now() < _timeout)
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+        const float _expected = Probe::level * 0.5f;
+        expect("jackd runs the clients", _probe.blocks >= _start + 32);
+        expect("routed with the gains of the routing", std::abs(_probe.received - _expected) < 1e-6,
+            std::format("received {}, expected {}", _probe.received.load(), _expected));
+        expect("still running", _client.running());
+        _client.close();
+    }
+
+    if (_probe.client) jack_client_close(std::exchange(_probe.client, nullptr));
+    kill(_jackd, SIGTERM);
+    waitpid(_jackd, nullptr, 0);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,124 @@
+#include "Realtime.hpp"
+#include "Trace.hpp"
+#include "Processing/Analyzer.hpp"
+#include "golden/Graph.hpp"
+#include "golden/Signals.hpp"
+
+// Built with MIXIJO_RT_CHECK. Checks that the checker catches allocations and locking a
+// mutex on a realtime thread, and that the processing graph does neither of them.
+namespace Mixijo {
+
+    static int failures = 0;
+
+    /**
+     * Run a function as the audio thread would, and compare the violations it caused.
+     * @param name what is checked
+     * @param expected number of violations the function should cause
+     * @param fn function to run in a realtime scope
+     */
+    static void expect(std::string_view name, std::size_t expected, const std::function<void(void)>& fn) {
+        const std::size_t _before = Realtime::violations();
+        {
+            MIXIJO_REALTIME();
+            fn();
+        }
+        const std::size_t _caused = Realtime::violations() - _before;
+        if (_caused != expected) ++failures;
+        std::cout << (_caused == expected ? "ok     " : "FAILED ") << name;
+        if (_caused != expected) std::cout << ": " << _caused << " violations, expected " << expected;
+        std::cout << '\n';
+    }
+}
+
+int main() {
+    using namespace Mixijo;
+
+    expect("allocation is caught", 2, [] { // The allocation and the free
+        void* _data = ::operator new(16); // Not a new expression, those may be optimized away
+        ::operator delete(_data);
+    });
+
+    expect("allowed allocation", 0, [] {
+        MIXIJO_REALTIME_ALLOW();
+        std::string _string(100, 'a');
+    });
+
+    Mutex _mutex;
+    expect("locking a free mutex is caught", 1, [&] { std::scoped_lock _{ _mutex }; });
+
+    expect("allowed lock", 0, [&] {
+        MIXIJO_REALTIME_ALLOW();
+        std::scoped_lock _{ _mutex };
+    });
+
+    expect("try_lock", 0, [&] { if (_mutex.try_lock()) _mutex.unlock(); });
+
+    std::atomic<bool> _locked = false;
+    std::thread _holder{ [&] {
+        std::scoped_lock _{ _mutex };
+        _locked = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    } };
+    while (!_locked) std::this_thread::yield();
+    expect("waiting for a mutex is caught", 1, [&] { std::scoped_lock _{ _mutex }; });
+    _holder.join();
+
+    // The graph of the processor, laid out like the processor does before the callback
+    Golden::Graph _graph;
+    for (std::size_t _width : { 1, 2, 3, 6, 8 }) _graph.input(_width, 0.5);
+    for (std::size_t _width : { 1, 2, 5, 6, 8 }) _graph.output(_width, 0.9);
+    _graph.layout(std::vector<double>(25, 0.5));
+    _graph.inputs[0].enableLimiter = true;
+
+    constexpr std::size_t _frames = 256;
+    Buffer<double> _in{ _graph.inputEndpoints, _frames };
+    Buffer<double> _out{ _graph.outputEndpoints, _frames };
+    for (std::size_t i = 0; i < _graph.inputEndpoints; ++i)
+        for (std::size_t j = 0; j < _frames; ++j) _in.data()[i][j] = Golden::noise(i, j);
+
+    Analyzer _analyzer;
+    _analyzer.open(false, 1, 48000);
+    {
+        MIXIJO_REALTIME_ALLOW(); // Claims the trace buffer of this thread, the audio thread does the same
+        Trace::thread("audio");
+    }
+
+    expect("processing graph", 0, [&] {
+        Trace::Zone _zone{ "block" };
+        _graph.process(_in, _out, &_analyzer, [&](std::size_t) {
+            _graph.inputs[0].process(); // The limiter
+        });
+    });
+
+    // The processor hands a new graph to the audio thread, which takes over the state of the old one
+    Scene _parameters;
+    _graph.capture(_parameters);
+    Graph _next{ _graph, _parameters };
+    expect("adopting a graph", 0, [&] {
+        _next.adopt(_graph);
+        _next.process(_in, _out, &_analyzer);
+    });
+    if (_next.inputs[0].smoothedGain != _graph.inputs[0].smoothedGain || _next.outputs[1].held[0] < _graph.outputs[1].held[0]) {
+        std::cout << "FAILED adopting a graph: the state of the channels wasn't taken over\n";
+        ++failures;
+    }
+
+    // Peaks are those of the last block, for the meter feedback, the held peaks stay until the gui reads them
+    Buffer<double> _silence{ _graph.inputEndpoints, _frames };
+    _next.process(_silence, _out);
+    if (_next.outputs[1].peaks[0] != 0 || _next.outputs[1].held[0] == 0) {
+        std::cout << "FAILED peaks: not reset every block, or the held peaks were\n";
+        ++failures;
+    }
+    _analyzer.close();
+
+    // Every violation is logged with its stack trace, up to a limit, then one line that there were more
+    std::size_t _reported = 0;
+    Realtime::report([&](std::string_view) { ++_reported; });
+    const std::size_t _total = Realtime::violations();
+    if (_reported != std::min(_total, Realtime::MaxViolations) + (_total > Realtime::MaxViolations)) {
+        std::cout << "FAILED report: logged " << _reported << " lines for " << _total << " violations\n";
+        ++failures;
+    }
+    return failures == 0 ? 0 : 1;
+}
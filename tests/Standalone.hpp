@@ -0,0 +1,98 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <concepts>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+/**
+ * Stands in for the audio, midi and gui libraries in the pch, so the engine
+ * code builds and runs without them, and without devices. Only what the
+ * engine code uses of them is here.
+ */
+namespace Audijo {
+
+    /**
+     * Non-interleaved buffer of samples, like the buffers of the audio callback.
+     */
+    template<class Ty>
+    class Buffer {
+    public:
+        /**
+         * Samples of all endpoints at one moment.
+         */
+        class Frame {
+        public:
+            Frame(Buffer& buffer, std::size_t index) : _buffer(&buffer), _index(index) {}
+
+            Ty& operator[](std::size_t endpoint) { return _buffer->_data[endpoint][_index]; }
+
+            struct Iterator {
+                Frame* frame;
+                std::size_t endpoint;
+                Ty& operator*() const { return (*frame)[endpoint]; }
+                Iterator& operator++() { return ++endpoint, *this; }
+                bool operator==(const Iterator& other) const { return endpoint == other.endpoint; }
+            };
+
+            Iterator begin() { return { this, 0 }; }
+            Iterator end() { return { this, _buffer->Channels() }; }
+
+        private:
+            Buffer* _buffer;
+            std::size_t _index;
+        };
+
+        /**
+         * @param channels number of endpoints
+         * @param frames number of samples per endpoint
+         */
+        Buffer(std::size_t channels, std::size_t frames)
+            : _samples(channels * frames), _data(channels), _frames(frames)
+        {
+            for (std::size_t i = 0; i < channels; ++i) _data[i] = _samples.data() + i * frames;
+        }
+
+        Frame operator[](std::size_t frame) { return { *this, frame }; }
+        Ty** data() { return _data.data(); }
+        std::size_t Channels() const { return _data.size(); }
+        std::size_t Frames() const { return _frames; }
+
+    private:
+        std::vector<Ty> _samples;
+        std::vector<Ty*> _data;
+        std::size_t _frames;
+    };
+}
+
+using namespace Audijo;
@@ -0,0 +1,19 @@
+#include "Scheduling.hpp"
+
+// Scheduling uses MMCSS and VirtualLock, the tests and benchmarks
+// run on any platform, so their threads keep the default scheduling.
+namespace Mixijo {
+
+    std::atomic<bool> Scheduling::_realtime{ false };
+    std::atomic<bool> Scheduling::_lockMemory{ false };
+    std::array<std::atomic<std::uint64_t>, Scheduling::Threads> Scheduling::_affinity{};
+    std::atomic<std::size_t> Scheduling::_generation{ 0 };
+
+    void Scheduling::configure(const Settings& settings) {
+        _lockMemory.store(settings.lockMemory, std::memory_order_relaxed);
+    }
+
+    void Scheduling::apply(Thread) {}
+    bool Scheduling::lock(const void*, std::size_t) { return false; }
+    void Scheduling::unlock(const void*, std::size_t) {}
+}
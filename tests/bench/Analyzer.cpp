@@ -0,0 +1,37 @@
+#include "Bench.hpp"
+#include "Processing/Analyzer.hpp"
+
+namespace Mixijo::Bench {
+
+    static Register _analyzer{ "analyzer", [] {
+        constexpr double _sampleRate = 48000;
+        Analyzer _analyzer;
+
+        // What the audio thread pays per frame, for the analyzed channel only
+        note("  tap, per frame of the analyzed channel");
+        for (std::size_t _width : { 1, 2, 8 }) {
+            std::vector<double> _values(_width, 0.25);
+            _analyzer.open(true, 0, _sampleRate);
+            measure(std::format("{} endpoints", _width), [&] {
+                for (std::size_t i = 0; i < 1024; ++i) _analyzer.tap(_values, 0.5);
+            }, 1024);
+            _analyzer.close();
+        }
+
+        // What the analysis thread costs, fed in real time like the audio thread would
+        note("  analysis thread, fed 1 second of a sine in blocks of 480 frames");
+        _analyzer.open(true, 0, _sampleRate);
+        std::vector<double> _values(2);
+        const std::clock_t _start = std::clock();
+        for (std::size_t _block = 0, _frame = 0; _block < 100; ++_block) {
+            for (std::size_t i = 0; i < 480; ++i, ++_frame) {
+                _values[0] = _values[1] = std::sin(_frame * 0.0654);
+                _analyzer.tap(_values, 1);
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        const double _cpu = static_cast<double>(std::clock() - _start) / CLOCKS_PER_SEC;
+        _analyzer.close();
+        note(std::format("  {:<44} {:>10.2f} %", "cpu time of the process per second of audio", _cpu * 100));
+    } };
+}
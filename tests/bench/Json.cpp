@@ -0,0 +1,104 @@
+#include "Bench.hpp"
+#include "Utils.hpp"
+#include "bench/LegacyJson.hpp"
+
+namespace Mixijo::Bench {
+
+    /**
+     * Settings of a large setup, with escaped strings, every kind of number and a theme.
+     * @param inputs number of input channels
+     * @param outputs number of output channels
+     */
+    static std::string settings(std::size_t inputs, std::size_t outputs) {
+        std::string _json = "{\n    \"audio\": \"Synchronous Audio Router\",\n    \"samplerate\": 48000,\n"
+            "    \"buffersize\": 1024,\n    \"midiin\": \"loopMIDI Port\",\n    \"midiout\": \"loopMIDI Port\",\n"
+            "    \"buttons\": [\n";
+        for (std::size_t i = 0; i < 16; ++i)
+            _json += std::format("        {{ \"cc\": {}, \"run\": \".\\\\scripts\\\\button_{}.bat\", \"debounce\": 250 }},\n", 20 + i, i);
+        _json += "        { \"cc\": 60, \"scene\": \"1\", \"fade\": 500 }\n    ],\n    \"channels\": {\n";
+
+        const auto _channels = [&](std::string_view key, std::size_t count, bool last) {
+            _json += std::format("        \"{}\": [\n", key);
+            for (std::size_t i = 0; i < count; ++i) {
+                _json += std::format("            {{ \"name\": \"{} {}\", \"endpoints\": [ \"{} {}\", \"{} {}\" ], "
+                    "\"midimapping\": [ {{ \"cc\": {}, \"lsb\": {}, \"param\": \"gain\", \"feedback\": true }}, "
+                    "{{ \"nrpn\": {}, \"param\": \"meter\" }} ] }}{}\n",
+                    key, i, key, 2 * i, key, 2 * i + 1, i % 32, i % 32 + 32, 1024 + i, i + 1 == count ? "" : ",");
+            }
+            _json += std::format("        ]{}\n", last ? "" : ",");
+        };
+        _channels("outputs", outputs, false);
+        _channels("inputs", inputs, true);
+        _json += "    },\n    \"theme\": {\n";
+
+        for (std::size_t i = 0; i < 32; ++i) {
+            _json += std::format("        \"block{}\": {{ \"background\": [ 30, 30, 30 ], \"border\": {{ \"color\": [ 60, 60, 60, 255 ], "
+                "\"hovering\": [ 80, 80, 80 ], \"transition\": 100 }}, \"borderWidth\": {{ \"value\": 1, \"selected\": 2 }}, "
+                "\"gain\": -1.5e-3, \"offset\": -12 }}{}\n", i, i + 1 == 32 ? "" : ",");
+        }
+        _json += "    }\n}\n";
+        return _json;
+    }
+
+    /**
+     * Object with many keys, every one of them is checked for duplicates.
+     * @param keys number of keys
+     */
+    static std::string wide(std::size_t keys) {
+        std::string _json = "{";
+        for (std::size_t i = 0; i < keys; ++i)
+            _json += std::format("{}\"key{}\": {}", i == 0 ? "" : ", ", i, i);
+        return _json + "}";
+    }
+
+    /**
+     * Streaming handler that only counts the tokens, so no DOM is built.
+     */
+    struct Count {
+        std::size_t tokens = 0;
+        void beginObject() { ++tokens; }
+        void endObject() { ++tokens; }
+        void beginArray() { ++tokens; }
+        void endArray() { ++tokens; }
+        void key(std::string_view, bool) { ++tokens; }
+        void value(std::string_view, bool) { ++tokens; }
+        void value(json::floating) { ++tokens; }
+        void value(json::integral) { ++tokens; }
+        void value(json::unsigned_integral) { ++tokens; }
+        void value(json::boolean) { ++tokens; }
+        void value(json::null) { ++tokens; }
+    };
+
+    static void parsers(std::string_view name, const std::string& content) {
+        const auto _legacy = Legacy::parse(content);
+        const auto _streaming = json::parse(content);
+        if (!_legacy || !_streaming || !(_legacy.value() == _streaming.value()))
+            return note(std::format("  {}: the parsers don't agree, skipped", name));
+
+        note(std::format("  {}, {} KiB", name, content.size() / 1024));
+        measure("legacy parser", [&] { keep(Legacy::parse(content)); });
+        measure("streaming parser, building the DOM", [&] { keep(json::parse(content)); });
+        measure("streaming parser, without a DOM", [&] {
+            Count _count;
+            keep(json::parse(content, _count));
+        });
+    }
+
+    static Register _json{ "json", [] {
+        parsers("settings with 200 inputs and 64 outputs", settings(200, 64));
+        parsers("settings with 1000 inputs and 256 outputs", settings(1000, 256));
+        parsers("object with 4000 keys", wide(4000));
+
+        // How the settings file used to be read, a copy through a stream iterator
+        const std::string _content = settings(1000, 256);
+        const std::filesystem::path _path = std::filesystem::temp_directory_path() / "mixijo_bench_settings.json";
+        std::ofstream{ _path, std::ios::binary } << _content;
+        note(std::format("  reading the settings, {} KiB", _content.size() / 1024));
+        measure("stream iterator copy", [&] {
+            std::ifstream _file{ _path };
+            keep(std::string{ std::istreambuf_iterator<char>{ _file }, std::istreambuf_iterator<char>{} });
+        });
+        measure("readFile", [&] { keep(readFile(_path)); });
+        std::filesystem::remove(_path);
+    } };
+}
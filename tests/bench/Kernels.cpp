@@ -0,0 +1,37 @@
+#include "Bench.hpp"
+#include "golden/Graph.hpp"
+#include "golden/Signals.hpp"
+
+namespace Mixijo::Bench {
+
+    /**
+     * Channels of one width, all inputs routed to all outputs.
+     * @param width endpoints of every channel
+     * @param specialized pick the kernels for the width, otherwise the generic ones are kept
+     */
+    static Golden::Graph graph(std::size_t width, bool specialized) {
+        Golden::Graph _graph;
+        for (std::size_t i = 0; i < 32; ++i) _graph.input(width, 0.5);
+        for (std::size_t i = 0; i < 8; ++i) _graph.output(width, 0.9);
+        _graph.layout(std::vector<double>(32 * 8, 0.25), specialized);
+        return _graph;
+    }
+
+    static Register _kernels{ "kernels", [] {
+        note("  32 inputs routed to 8 outputs of the same width, per frame");
+        for (std::size_t _width : { 1, 2, 6, 8 }) {
+            for (bool _specialized : { false, true }) {
+                Golden::Graph _graph = graph(_width, _specialized);
+                constexpr std::size_t _frames = 256;
+                Buffer<double> _in{ _graph.inputEndpoints, _frames };
+                Buffer<double> _out{ _graph.outputEndpoints, _frames };
+                for (std::size_t i = 0; i < _in.Channels(); ++i)
+                    for (std::size_t j = 0; j < _frames; ++j) _in.data()[i][j] = Golden::noise(i, j);
+
+                measure(std::format("width {}, {}", _width, _specialized ? "specialized" : "generic"), [&] {
+                    _graph.process(_in, _out);
+                }, _frames);
+            }
+        }
+    } };
+}
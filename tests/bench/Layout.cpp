@@ -0,0 +1,104 @@
+#include "Bench.hpp"
+#include "Processing/Arena.hpp"
+#include "Processing/Channel.hpp"
+#include "golden/Signals.hpp"
+
+namespace Mixijo::Bench {
+
+    /**
+     * Stereo channels fully routed, processed with the kernels in the order of
+     * Graph::process. Only where the samples, peaks and routing live differs,
+     * in one arena like a graph lays them out, or in an allocation per array.
+     */
+    struct Mix {
+        std::vector<InputChannel> inputs;
+        std::vector<OutputChannel> outputs;
+        Arena arena;
+        std::vector<std::unique_ptr<std::vector<double>>> heap;
+
+        /**
+         * @param inputs number of stereo inputs
+         * @param outputs number of stereo outputs
+         * @param scattered own allocation for every array of every channel, like before the arena
+         * @param spread allocate other sizes in between, so they end up spread over the heap like in a running app
+         */
+        Mix(std::size_t inputs, std::size_t outputs, bool scattered, bool spread = true)
+            : inputs(inputs), outputs(outputs)
+        {
+            int _endpoint = 0;
+            for (auto& _input : this->inputs) _input.add(_endpoint++), _input.add(_endpoint++);
+            _endpoint = 0;
+            for (auto& _output : this->outputs) _output.add(_endpoint++), _output.add(_endpoint++);
+
+            const std::size_t _samples = 2 * (inputs + outputs);
+            if (!scattered) arena = Arena{ 2 * Arena::aligned(_samples) + inputs * outputs };
+            const std::span<double> _values = arena.take(_samples, true);
+            const std::span<double> _peaks = arena.take(_samples, true);
+            const std::span<double> _levels = arena.take(inputs * outputs, true);
+
+            std::size_t _offset = 0;
+            const auto _take = [&](std::span<double> arena, std::size_t offset, std::size_t count) -> std::span<double> {
+                if (!scattered) return arena.subspan(offset, count);
+                auto& _array = *heap.emplace_back(std::make_unique<std::vector<double>>(count));
+                if (spread) heap.push_back(std::make_unique<std::vector<double>>(24 + heap.size() % 7 * 40));
+                return _array;
+            };
+            const auto _place = [&](Channel& channel) {
+                channel.values = _take(_values, _offset, 2);
+                channel.peaks = _take(_peaks, _offset, 2);
+                _offset += 2;
+            };
+
+            for (std::size_t i = 0; auto& _input : this->inputs) {
+                _place(_input);
+                _input.specialize();
+                _input.output_levels = _take(_levels, i++ * outputs, outputs);
+                std::ranges::fill(_input.output_levels, 0.5);
+            }
+            for (auto& _output : this->outputs) {
+                _place(_output);
+                _output.specialize();
+            }
+        }
+
+        void process(Buffer<double>& in, Buffer<double>& out) {
+            for (std::size_t i = 0; i < in.Frames(); ++i) {
+                auto _inFrame = in[i], _outFrame = out[i];
+                for (auto& _input : inputs) {
+                    _input.generate(_inFrame);
+                    if (_input.idle) continue;
+                    for (std::size_t j = 0; double _level : _input.output_levels)
+                        outputs[j++].receive(_input.values, _level);
+                }
+                for (auto& _output : outputs) _output.generate(_outFrame);
+                for (auto& _endpoint : _outFrame) _endpoint = std::clamp(_endpoint, -1., 1.);
+            }
+        }
+    };
+
+    static void layouts(std::size_t inputs, std::size_t outputs) {
+        constexpr std::size_t _frames = 256;
+        Buffer<double> _in{ 2 * inputs, _frames };
+        Buffer<double> _out{ 2 * outputs, _frames };
+        for (std::size_t i = 0; i < _in.Channels(); ++i)
+            for (std::size_t j = 0; j < _frames; ++j) _in.data()[i][j] = Golden::noise(i, j);
+
+        // Every change of the channels lays out a new graph, see Processor::access
+        note(std::format("  {} stereo inputs routed to {} stereo outputs, laying out", inputs, outputs));
+        measure("own allocations per channel", [&] { keep(Mix{ inputs, outputs, true, false }); });
+        measure("arena", [&] { keep(Mix{ inputs, outputs, false }); });
+
+        // Measured without a difference beyond the noise, kept to see it stays that way
+        note(std::format("  {} stereo inputs routed to {} stereo outputs, per frame", inputs, outputs));
+        Mix _scattered{ inputs, outputs, true };
+        measure("own allocations per channel", [&] { _scattered.process(_in, _out); }, _frames);
+        Mix _arena{ inputs, outputs, false };
+        measure("arena", [&] { _arena.process(_in, _out); }, _frames);
+    }
+
+    static Register _layout{ "layout", [] {
+        layouts(16, 8);
+        layouts(64, 16);
+        layouts(200, 64);
+    } };
+}
@@ -0,0 +1,152 @@
+#pragma once
+#include "pch.hpp"
+#include "Utils.hpp"
+
+/**
+ * The recursive descent parser settings.json was parsed with before the
+ * streaming parser, only kept to compare the two. Unchanged, except that
+ * it's moved out of the json class.
+ */
+namespace Mixijo::Legacy {
+
+    std::optional<json> parseJsonValue(std::string_view& val);
+
+    inline std::string removeDoubleEscapes(std::string_view str) {
+        std::string _str{ str };
+        for (auto _i = _str.begin(); _i != _str.end();)
+            if (*_i == '\\') ++(_i = _str.erase(_i)); else ++_i;
+        return _str;
+    }
+
+    inline bool consume(std::string_view& val, char c, bool empty = false) {
+        if ((val = trim(val)).empty() || !val.starts_with(c)) return false;
+        return !(val = trim(val.substr(1))).empty() || empty;
+    }
+
+    inline bool consume(std::string_view& val, std::string_view word) {
+        return val.starts_with(word) ? val = val.substr(word.size()), true : false;
+    }
+
+    inline std::optional<json> parseJsonBool(std::string_view& val) {
+        return consume(val, "true") ? true
+            : consume(val, "false") ? false : std::optional<json>{};
+    }
+
+    inline std::optional<json> parseJsonNull(std::string_view& val) {
+        return consume(val, "null") ? nullptr : std::optional<json>{};
+    }
+
+    inline std::optional<json> parseJsonNumber(std::string_view& val) {
+        std::string_view _json = val;
+        std::size_t _size = 0ull;
+        bool _floating = false, _signed = false;
+        auto _isDigit = [&] { return oneOf(_json.front(), "0123456789"); };
+        auto _consume = [&] { return ++_size, !(_json = _json.substr(1)).empty(); };
+        auto _consumeDigits = [&] {
+            if (!_isDigit()) return false;
+            while (_isDigit()) if (!_consume()) return false;
+            return true;
+        };
+
+        if ((_signed = _json.starts_with('-')))
+            if (!_consume()) return {};
+
+        if (_json.starts_with('0')) {
+            if (!_consume()) return {};
+            if (_isDigit()) return {};
+        }
+        else if (!_consumeDigits()) return {};
+
+        if ((_floating = _json.starts_with('.'))) {
+            if (!_consume()) return {};
+            if (!_consumeDigits()) return {};
+        }
+
+        if (oneOf(_json.front(), "eE")) {
+            if (!_consume()) return {};
+            if (oneOf(_json.front(), "-+") && !_consume()) return {};
+            if (!_consumeDigits()) return {};
+        }
+
+        _json = val.substr(0, _size);
+        auto _parse = [&]<class Ty>(Ty val) {
+            std::from_chars(_json.data(), _json.data() + _json.size(), val);
+            return json{ val };
+        };
+        val = val.substr(_size);
+        return _floating ? _parse(0.0) : _signed ? _parse(0ll) : _parse(0ull);
+    }
+
+    inline std::optional<json> parseJsonString(std::string_view& val) {
+        std::string_view _json = val, _result = _json;
+        if (!consume(_json, '"')) return {};
+        if (consume(_json, '"')) return val = _json, "";
+        for (std::size_t _offset = 1ull;;) {
+            std::size_t _index = _json.find_first_of('"');
+            if (_index == std::string_view::npos) return {};
+            if (_result[_offset + _index - 1] == '\\') {
+                std::size_t _check = _offset + _index - 1;
+                std::size_t _count = 0;
+                while (_result[_check] == '\\') {
+                    ++_count;
+                    if (_check-- == 0) break;
+                }
+                if (_count % 2 == 0) {
+                    val = _result.substr(_offset + _index + 1);
+                    return removeDoubleEscapes(_result.substr(1, _offset + _index - 1));
+                }
+                else {
+                    _offset += _index + 1;
+                    _json = _result.substr(_offset);
+                }
+            }
+            else {
+                val = _result.substr(_offset + _index + 1);
+                return removeDoubleEscapes(_result.substr(1, _offset + _index - 1));
+            }
+        }
+    }
+
+    inline std::optional<json> parseJsonArray(std::string_view& val) {
+        std::string_view _json = val;
+        if (!consume(_json, '[')) return {};
+        std::optional<json> _result = json::array{}, _value = {};
+        while ((_value = parseJsonValue(_json))) {
+            _result.value().emplace(_value.value());
+            if (!consume(_json, ',')) break;
+        }
+        if (!consume(_json, ']', true)) return {};
+        return val = _json, _result;
+    }
+
+    inline std::optional<json> parseJsonObject(std::string_view& val) {
+        std::string_view _json = val;
+        if (!consume(_json, '{')) return {};
+        std::optional<json> _result = json::object{}, _value = {};
+        while ((_value = parseJsonString(_json))) {
+            std::string _key = _value.value().as<json::string>();
+            if (!consume(_json, ':')) return {};
+            if (!(_value = parseJsonValue(_json))) return {};
+            _result.value()[_key] = _value.value();
+            if (!consume(_json, ',')) break;
+        }
+        if (!consume(_json, '}', true)) return {};
+        return val = _json, _result;
+    }
+
+    inline std::optional<json> parseJsonValue(std::string_view& val) {
+        std::optional<json> _result = {};
+        return (_result = parseJsonString(val)) || (_result = parseJsonArray(val))
+            || (_result = parseJsonObject(val)) || (_result = parseJsonBool(val))
+            || (_result = parseJsonNumber(val)) || (_result = parseJsonNull(val))
+            ? _result : std::optional<json>{};
+    }
+
+    inline std::optional<json> parse(std::string_view val) {
+        if ((val = trim(val)).empty()) return {};
+        std::optional<json> _result = {};
+        if ((_result = parseJsonObject(val)) && trim(val).empty()) return _result;
+        if ((_result = parseJsonArray(val)) && trim(val).empty()) return _result;
+        return {};
+    }
+}
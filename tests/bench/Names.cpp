@@ -0,0 +1,110 @@
+#include "Bench.hpp"
+#include "Utils.hpp"
+
+namespace Mixijo::Bench {
+
+    /**
+     * What the old scans looked at, a list of named things with an id,
+     * like the endpoints of the device and the strips of the mixer.
+     */
+    struct Named {
+        std::string name;
+        bool input;
+        int id;
+    };
+
+    /**
+     * Name resolution of a startup, the endpoints of every strip, then every line
+     * of the routing file with its connected outputs, like applyChannels and loadRouting.
+     */
+    struct Startup {
+        std::vector<Named> endpoints;
+        std::vector<Named> strips;
+        std::vector<std::string> routing;
+        std::vector<std::pair<std::string, std::string>> stripEndpoints[2]; // Outputs, inputs
+
+        /**
+         * @param endpoints channels of the device, per direction
+         * @param inputs input strips
+         * @param outputs output strips
+         * @param connected outputs every input is routed to
+         */
+        Startup(int endpoints, int inputs, int outputs, int connected) {
+            for (int i = 0; i < endpoints; ++i) {
+                this->endpoints.push_back({ std::format("Input {}", i + 1), true, i });
+                this->endpoints.push_back({ std::format("Output {}", i + 1), false, i });
+            }
+            for (int i = 0; i < outputs; ++i) {
+                strips.push_back({ std::format("Out {}", i), false, i });
+                stripEndpoints[0].emplace_back(std::format("Output {}", 2 * i % endpoints + 1), std::format("Output {}", (2 * i + 1) % endpoints + 1));
+                routing.push_back(std::format("Out {}:[gain=1.000000,mute=0]", i));
+            }
+            for (int i = 0; i < inputs; ++i) {
+                strips.push_back({ std::format("In {}", i), true, i });
+                stripEndpoints[1].emplace_back(std::format("Input {}", 2 * i % endpoints + 1), std::format("Input {}", (2 * i + 1) % endpoints + 1));
+                std::string _line = std::format("In {}:[gain=0.500000,mute=0]:[", i);
+                for (int j = 0; j < connected; ++j) _line += std::format("{}Out {}", j == 0 ? "" : ",", (i + j) % outputs);
+                routing.push_back(_line + "]");
+            }
+        }
+
+        /**
+         * @param find resolves a name to an id, -1 when not found
+         * @return sum of the ids, so nothing is optimized away
+         */
+        template<class Find>
+        long resolve(Find find) const {
+            long _sum = 0;
+            for (bool _input : { false, true })
+                for (auto& [_left, _right] : stripEndpoints[_input])
+                    _sum += find(_left, _input, true) + find(_right, _input, true);
+
+            for (std::string_view _view : routing) {
+                auto _parts = split(_view, ':');
+                const bool _isInput = _parts.size() == 3;
+                const int _channelId = find(trim(_parts[0]), _isInput, false);
+                if (_channelId == -1) continue;
+                _sum += _channelId;
+                if (!_isInput) continue;
+                for (auto _name : split(trim(_parts[2], " \t\n\r\f\v[]"), ','))
+                    _sum += find(trim(_name), false, false);
+            }
+            return _sum;
+        }
+    };
+
+    static void startup(int endpoints, int inputs, int outputs, int connected) {
+        const Startup _startup{ endpoints, inputs, outputs, connected };
+        note(std::format("  {} endpoints, {} inputs and {} outputs, every input routed to {}", endpoints, inputs, outputs, connected));
+
+        const auto _scan = [&](std::string_view name, bool input, bool endpoint) {
+            for (auto& _named : endpoint ? _startup.endpoints : _startup.strips)
+                if (_named.input == input && _named.name == name) return _named.id;
+            return -1;
+        };
+
+        // Indexes are rebuilt when the device opens and when the channels change, so building them counts
+        const auto _indexed = [&] {
+            string_map<int> _indexes[2][2]; // [endpoint][input]
+            for (auto& _named : _startup.endpoints) _indexes[1][_named.input].emplace(_named.name, _named.id);
+            for (auto& _named : _startup.strips) _indexes[0][_named.input].emplace(_named.name, _named.id);
+            return _startup.resolve([&](std::string_view name, bool input, bool endpoint) {
+                auto& _index = _indexes[endpoint][input];
+                auto _it = _index.find(name);
+                return _it == _index.end() ? -1 : _it->second;
+            });
+        };
+
+        if (_startup.resolve(_scan) != _indexed())
+            return note("  the scan and the indexes don't agree, skipped");
+
+        measure("linear scans", [&] { keep(_startup.resolve(_scan)); });
+        measure("hash indexes, including building them", [&] { keep(_indexed()); });
+    }
+
+    static Register _names{ "names", [] {
+        startup(64, 32, 16, 4);
+        startup(256, 200, 64, 16);
+        startup(256, 200, 64, 64);
+    } };
+}
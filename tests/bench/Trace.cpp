@@ -0,0 +1,32 @@
+#include "Bench.hpp"
+#include "Trace.hpp"
+
+namespace Mixijo::Bench {
+
+    static Register _trace{ "trace", [] {
+        // The benchmarks are built without MIXIJO_TRACING, so the macro is what a normal build pays
+        note("  per zone");
+        measure("MIXIJO_TRACE, tracing disabled", [] {
+            for (int i = 0; i < 1024; ++i) {
+                MIXIJO_TRACE("disabled");
+                keep(i);
+            }
+        }, 1024);
+        measure("loop without a zone", [] {
+            for (int i = 0; i < 1024; ++i) keep(i);
+        }, 1024);
+        measure("Trace::Zone, tracing enabled", [] {
+            for (int i = 0; i < 1024; ++i) {
+                Trace::Zone _zone{ "enabled" };
+                keep(i);
+            }
+        }, 1024);
+        measure("steady_clock::now, a zone reads it twice", [] {
+            for (int i = 0; i < 1024; ++i) keep(std::chrono::steady_clock::now());
+        }, 1024);
+
+        // Only the first zone of a thread claims a buffer, a full one is dumped here
+        note(std::format("  dumping {} zones", Trace::Capacity));
+        measure("Trace::dump", [] { keep(Trace::dump()); });
+    } };
+}
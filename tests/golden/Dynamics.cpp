@@ -0,0 +1,64 @@
+#include "Golden.hpp"
+#include "golden/Signals.hpp"
+#include "Processing/Channel.hpp"
+
+namespace Mixijo::Golden {
+
+    // log10 and pow differ in the last bits between math libraries, so compare in dB
+    constexpr Tolerance _dynamics{ .ulps = 64, .db = 1e-6, .floor = -200 };
+
+    static Register _compressor{ "compressor_burst", [] {
+        Compressor _compressor;
+        Rows _rows;
+        for (std::size_t i = 0; i < 2048; ++i) {
+            // Quiet, then a burst well above the threshold, then quiet again, so it attacks and releases
+            const double _amplitude = i >= 256 && i < 1024 ? 0.9 : 0.005;
+            auto& _row = _rows.emplace_back();
+            for (int c = 0; c < 2; ++c) _row.push_back(_compressor.process(sine(i, 220 * (c + 1), _amplitude), c));
+        }
+        _rows.push_back({ _compressor.compressEnvelope, _compressor.compressMult });
+        return _rows;
+    }, _dynamics };
+
+    static Register _compressorSilence{ "compressor_silence", [] {
+        Compressor _compressor;
+        Rows _rows;
+        for (std::size_t i = 0; i < 256; ++i) // Mutes after 100 zeros, until a sample comes in
+            _rows.push_back({ _compressor.process(i < 16 ? 0.5 : i < 200 ? 0. : sine(i, 1000, 0.5), 0) });
+        return _rows;
+    }, _dynamics };
+
+    static Register _limiter{ "limiter_overdrive", [] {
+        Limiter _limiter;
+        _limiter.delayedBuffer.assign(2, std::vector<double>(144));
+        Rows _rows;
+        for (std::size_t i = 0; i < 2048; ++i) {
+            auto& _row = _rows.emplace_back();
+            for (int c = 0; c < 2; ++c) _row.push_back(_limiter.process(sine(i, 100, c == 0 ? 2. : 0.4), c));
+        }
+        return _rows;
+    }, _dynamics };
+
+    // The limiter as a channel applies it, with the smoothed gain after it
+    static Register _channelLimiter{ "channel_limiter", [] {
+        Channel _channel;
+        _channel.add(0);
+        _channel.add(1);
+        std::vector<double> _memory(4);
+        _channel.values = std::span{ _memory }.subspan(0, 2);
+        _channel.peaks = std::span{ _memory }.subspan(2, 2);
+        _channel.enableLimiter = true;
+        _channel.prepare(48000);
+        _channel.gain = 0.5;
+
+        Rows _rows;
+        for (std::size_t i = 0; i < 1024; ++i) {
+            _channel.values[0] = noise(0, i) * 3;
+            _channel.values[1] = sine(i, 60, 1.5);
+            _channel.process();
+            _rows.emplace_back(_channel.values.begin(), _channel.values.end());
+        }
+        _rows.emplace_back(_channel.peaks.begin(), _channel.peaks.end());
+        return _rows;
+    }, _dynamics };
+}
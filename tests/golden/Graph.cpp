@@ -0,0 +1,69 @@
+#include "golden/Graph.hpp"
+#include "golden/Signals.hpp"
+
+namespace Mixijo::Golden {
+
+    static Register _impulse{ "impulse_stereo", [] {
+        Graph _graph;
+        _graph.input(2, 0.5);
+        _graph.output(2, 0.8);
+        _graph.layout({ 1 });
+        return _graph.process(64, [](std::size_t endpoint, std::size_t frame) {
+            return impulse(frame, endpoint == 0 ? 0 : 7);
+        });
+    } };
+
+    static Register _monoToStereo{ "sine_mono_to_stereo", [] {
+        Graph _graph;
+        _graph.input(1, 0.7);
+        _graph.output(2);
+        _graph.output(1, 0.5);
+        _graph.layout({ 1, 0.25 });
+        return _graph.process(256, [](std::size_t, std::size_t frame) { return sine(frame, 1000); });
+    } };
+
+    // Every width that has its own kernel, and some that use the generic one
+    static Register _widths{ "noise_widths", [] {
+        Graph _graph;
+        for (std::size_t _width : { 1, 2, 3, 6, 8 }) _graph.input(_width, 0.5);
+        for (std::size_t _width : { 1, 2, 5, 6, 8 }) _graph.output(_width, 0.9);
+        std::vector<double> _routing;
+        for (std::size_t i = 0; i < 5; ++i)
+            for (std::size_t j = 0; j < 5; ++j) _routing.push_back((i + j) % 3 == 0 ? 0 : 0.2 * (j + 1));
+        _graph.layout(_routing);
+        return _graph.process(128, [](std::size_t endpoint, std::size_t frame) { return noise(endpoint, frame); });
+    } };
+
+    static Register _silence{ "silence", [] {
+        Graph _graph;
+        _graph.input(2);
+        _graph.input(2);
+        _graph.output(2);
+        _graph.layout({ 1, 1 });
+        return _graph.process(32, [](std::size_t endpoint, std::size_t frame) {
+            return endpoint < 2 ? 0. : impulse(frame, 16); // The first input stays idle
+        });
+    } };
+
+    // Inputs summed past full scale, clamped at the device
+    static Register _overdrive{ "overdrive_clamp", [] {
+        Graph _graph;
+        _graph.input(2, 1.5);
+        _graph.input(2, 1.5);
+        _graph.output(2);
+        _graph.layout({ 1, 1 });
+        return _graph.process(128, [](std::size_t endpoint, std::size_t frame) { return sine(frame, 440 * (1 + endpoint)); });
+    } };
+
+    // Gain changes are smoothed per sample
+    static Register _gainRamp{ "gain_ramp", [] {
+        Graph _graph;
+        _graph.input(1);
+        _graph.output(1);
+        _graph.layout({ 1 });
+        return _graph.process(512, [](std::size_t, std::size_t) { return 0.5; }, [](Graph& graph, std::size_t frame) {
+            if (frame == 32) graph.inputs[0].gain = 0.25;
+            if (frame == 256) graph.outputs[0].gain = 2;
+        });
+    } };
+}
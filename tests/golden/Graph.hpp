@@ -0,0 +1,76 @@
+#pragma once
+#include "Golden.hpp"
+#include "Processing/Graph.hpp"
+
+namespace Mixijo::Golden {
+
+    /**
+     * Channels and routing built in code, processed by the graph of the engine,
+     * in one block, with parameter changes between the frames.
+     */
+    struct Graph : Mixijo::Graph {
+        std::size_t inputEndpoints = 0;
+        std::size_t outputEndpoints = 0;
+
+        /**
+         * @param endpoints number of endpoints, each is a new endpoint of the device
+         * @param gain gain of the channel, it starts there without smoothing
+         */
+        void input(std::size_t endpoints, double gain = 1) {
+            auto& _input = inputs.emplace_back();
+            for (std::size_t i = 0; i < endpoints; ++i) _input.add(static_cast<int>(inputEndpoints++));
+            _input.gain = _input.smoothedGain = gain;
+            _input.prepare(48000);
+        }
+
+        void output(std::size_t endpoints, double gain = 1) {
+            auto& _output = outputs.emplace_back();
+            for (std::size_t i = 0; i < endpoints; ++i) _output.add(static_cast<int>(outputEndpoints++));
+            _output.gain = _output.smoothedGain = gain;
+            _output.prepare(48000);
+        }
+
+        /**
+         * Lay out the channels like the processor does, call after adding all of them.
+         * @param routing level of every input to every output, outputs per input
+         * @param specialize pick the kernels for the widths, like the processor, otherwise keep the generic ones
+         */
+        void layout(const std::vector<double>& routing, bool specialize = true) {
+            Mixijo::Graph::layout(specialize);
+            for (std::size_t i = 0; auto& _input : inputs)
+                for (double& _level : _input.output_levels) _level = routing[i++];
+        }
+
+        /**
+         * Process all frames of the signal, every endpoint gets its own signal.
+         * @param frames number of frames
+         * @param signal sample of an input endpoint at a frame
+         * @param change called before every frame, to change parameters
+         * @return output endpoints per frame
+         */
+        Rows process(std::size_t frames, std::function<double(std::size_t, std::size_t)> signal,
+            std::function<void(Graph&, std::size_t)> change = {})
+        {
+            Buffer<double> _in{ inputEndpoints, frames };
+            Buffer<double> _out{ outputEndpoints, frames };
+            for (std::size_t i = 0; i < frames; ++i)
+                for (std::size_t j = 0; j < inputEndpoints; ++j) _in.data()[j][i] = signal(j, i);
+
+            Mixijo::Graph::process(_in, _out, nullptr, [&](std::size_t i) { if (change) change(*this, i); });
+
+            Rows _rows;
+            for (std::size_t i = 0; i < frames; ++i) {
+                auto& _row = _rows.emplace_back();
+                for (auto& _endpoint : _out[i]) _row.push_back(_endpoint);
+            }
+
+            // Peaks of every channel as the last row, they feed the meters
+            auto& _peaks = _rows.emplace_back();
+            for (auto& _input : inputs) _peaks.insert(_peaks.end(), _input.peaks.begin(), _input.peaks.end());
+            for (auto& _output : outputs) _peaks.insert(_peaks.end(), _output.peaks.begin(), _output.peaks.end());
+            return _rows;
+        }
+
+        using Mixijo::Graph::process;
+    };
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include "pch.hpp"
+
+namespace Mixijo::Golden {
+
+    /**
+     * Deterministic test signals, the same on every platform
+     * as long as the math library rounds sin the same.
+     */
+    inline double impulse(std::size_t frame, std::size_t at = 0) { return frame == at ? 1. : 0.; }
+
+    inline double sine(std::size_t frame, double frequency, double amplitude = 1, double sampleRate = 48000) {
+        constexpr double _pi = 3.14159265358979323846;
+        return amplitude * std::sin(2 * _pi * frequency * frame / sampleRate);
+    }
+
+    // Uniform in [-1, 1), from an lcg seeded by the endpoint, so it doesn't depend on the standard library
+    inline double noise(std::size_t endpoint, std::size_t frame) {
+        std::uint64_t _state = 0x9E3779B97F4A7C15ull * (endpoint + 1) + frame * 0xD1B54A32D192ED03ull;
+        for (int i = 0; i < 3; ++i) _state = _state * 6364136223846793005ull + 1442695040888963407ull;
+        return static_cast<double>(_state >> 11) / static_cast<double>(std::uint64_t{ 1 } << 52) - 1;
+    }
+}